@@ -0,0 +1,64 @@
+#include "BackgroundLayer.h"
+
+BackgroundLayer::BackgroundLayer(void)
+{
+  _u8g2 = NULL;
+  _size = 0;
+  _key = 0;
+  _valid = false;
+  _hits = 0;
+  _misses = 0;
+}
+
+void BackgroundLayer::begin(u8g2_t *u8g2)
+{
+  _u8g2 = u8g2;
+  _size = 0;
+
+  // Only a full frame buffer holds the whole layer
+  if (u8g2_GetBufferTileHeight(u8g2) == u8g2_GetU8x8(u8g2)->display_info->tile_height) {
+    _size = u8g2_GetBufferTileWidth(u8g2) * u8g2_GetBufferTileHeight(u8g2) * 8;
+  }
+
+  invalidate();
+}
+
+void BackgroundLayer::invalidate(void)
+{
+  _valid = false;
+}
+
+bool BackgroundLayer::restore(uint32_t key)
+{
+  if (_valid && _key == key) {
+    memcpy(u8g2_GetBufferPtr(_u8g2), _layer, _size);
+    _hits++;
+    return true;
+  }
+
+  u8g2_ClearBuffer(_u8g2);
+  _misses++;
+  return false;
+}
+
+void BackgroundLayer::store(uint32_t key)
+{
+  // Page buffer mode or a display bigger than the cache: draw every frame
+  if (_size == 0 || _size > BACKGROUND_LAYER_BUFFER_SIZE) {
+    return;
+  }
+
+  memcpy(_layer, u8g2_GetBufferPtr(_u8g2), _size);
+  _key = key;
+  _valid = true;
+}
+
+uint32_t BackgroundLayer::getHits(void)
+{
+  return _hits;
+}
+
+uint32_t BackgroundLayer::getMisses(void)
+{
+  return _misses;
+}
@@ -0,0 +1,43 @@
+#ifndef BackgroundLayer_h
+#define BackgroundLayer_h
+
+#include <Arduino.h>
+#include <U8g2lib.h>
+
+// Size of the cached layer, enough for a 128x64 full frame buffer
+#define BACKGROUND_LAYER_BUFFER_SIZE 1024
+
+// Keeps a copy of the static part of a watch face. The key describes
+// everything the static part depends on (face and geometry), a different
+// key means the cached copy is stale.
+class BackgroundLayer
+{
+
+public:
+  BackgroundLayer(void);
+
+  void begin(u8g2_t *u8g2);
+  void invalidate(void);
+
+  // Copies the cached layer to the frame buffer. If the key does not match,
+  // the frame buffer is cleared and false is returned: draw the static
+  // elements and call store() with the same key.
+  bool restore(uint32_t key);
+  void store(uint32_t key);
+
+  uint32_t getHits(void);
+  uint32_t getMisses(void);
+
+protected:
+  u8g2_t *_u8g2;
+  uint8_t _layer[BACKGROUND_LAYER_BUFFER_SIZE];
+  uint16_t _size;
+  uint32_t _key;
+  bool _valid;
+
+  uint32_t _hits;
+  uint32_t _misses;
+
+};
+
+#endif
@@ -0,0 +1,150 @@
+#include "BoxFill.h"
+
+// The frame buffer is a byte array, word access must not be reordered
+// against the byte access
+typedef uint32_t __attribute__((__may_alias__)) BoxFillWord;
+
+BoxFill::BoxFill(void)
+{
+  _boxes = 0;
+  _fallbacks = 0;
+  _bytes = 0;
+  _micros = 0;
+}
+
+void BoxFill::drawBox(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h)
+{
+  if (!fill(u8g2, x, y, w, h)) {
+    _fallbacks++;
+    u8g2_DrawBox(u8g2, x, y, w, h);
+  }
+}
+
+void BoxFill::drawHLine(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w)
+{
+  if (!fill(u8g2, x, y, w, 1)) {
+    _fallbacks++;
+    u8g2_DrawHLine(u8g2, x, y, w);
+  }
+}
+
+// The corners are drawn twice like in u8g2_DrawFrame(), which matters for
+// XOR
+void BoxFill::drawFrame(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h)
+{
+  if (w == 0 || h == 0 || !fill(u8g2, x, y, w, 1)) {
+    _fallbacks++;
+    u8g2_DrawFrame(u8g2, x, y, w, h);
+    return;
+  }
+
+  fill(u8g2, x, y, 1, h);
+  fill(u8g2, x + w - 1, y, 1, h);
+  fill(u8g2, x, y + h - 1, w, 1);
+}
+
+// False if the box has to be drawn by u8g2
+bool BoxFill::fill(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h)
+{
+  if (u8g2->cb != &u8g2_cb_r0 || u8g2->ll_hvline != u8g2_ll_hvline_vertical_top_lsb) {
+    return false;
+  }
+  if ((uint32_t)x + w > (u8g2_uint_t)-1 || (uint32_t)y + h > (u8g2_uint_t)-1) {
+    return false;
+  }
+
+  _boxes++;
+
+  #ifdef DISPLAYSTATS
+  uint32_t start = micros();
+  #endif
+
+  int16_t x0 = x > u8g2->user_x0 ? x : u8g2->user_x0;
+  int16_t x1 = x + w < u8g2->user_x1 ? x + w : u8g2->user_x1;
+  int16_t y0 = y > u8g2->user_y0 ? y : u8g2->user_y0;
+  int16_t y1 = y + h < u8g2->user_y1 ? y + h : u8g2->user_y1;
+
+  #ifdef U8G2_WITH_CLIP_WINDOW_SUPPORT
+  if (u8g2->is_page_clip_window_intersection == 0) {
+    x1 = x0;
+  }
+  #endif
+
+  if (x0 < x1 && y0 < y1) {
+    uint8_t color = u8g2->draw_color;
+    uint16_t stride = u8g2_GetU8x8(u8g2)->display_info->tile_width * 8;
+    uint8_t *buffer = u8g2->tile_buf_ptr + x0;
+
+    for (int16_t row = y0; row < y1; row = (row | 7) + 1) {
+      int16_t last = (row | 7) < y1 - 1 ? (row | 7) : y1 - 1;
+      uint8_t mask = (uint8_t)(0xFF << (row & 7)) & (uint8_t)(0xFF >> (7 - (last & 7)));
+
+      fillRow(buffer + ((row - u8g2->pixel_curr_row) >> 3) * stride, mask, x1 - x0, color);
+      _bytes += x1 - x0;
+    }
+  }
+
+  #ifdef DISPLAYSTATS
+  _micros += micros() - start;
+  #endif
+  return true;
+}
+
+void BoxFill::fillByte(uint8_t *target, uint8_t mask, uint8_t color)
+{
+  if (color == 1) {
+    *target |= mask;
+  } else if (color == 0) {
+    *target &= ~mask;
+  } else {
+    *target ^= mask;
+  }
+}
+
+// Sets, clears or, for other colors, inverts the mask bits of count bytes
+void BoxFill::fillRow(uint8_t *target, uint8_t mask, uint16_t count, uint8_t color)
+{
+  if (mask == 0xFF && color <= 1) {
+    memset(target, color == 1 ? 0xFF : 0x00, count);
+    return;
+  }
+
+  // Single bytes up to the first word boundary
+  while (count > 0 && ((uintptr_t)target & 3) != 0) {
+    fillByte(target++, mask, color);
+    count--;
+  }
+
+  BoxFillWord *word = (BoxFillWord *)target;
+  BoxFillWord *end = word + (count >> 2);
+  uint32_t wide = mask * 0x01010101UL;
+
+  if (color == 1) {
+    while (word < end) *word++ |= wide;
+  } else if (color == 0) {
+    while (word < end) *word++ &= ~wide;
+  } else {
+    while (word < end) *word++ ^= wide;
+  }
+
+  target = (uint8_t *)word;
+  count &= 3;
+  while (count-- > 0) {
+    fillByte(target++, mask, color);
+  }
+}
+
+uint32_t BoxFill::getBoxes(void)
+{
+  return _boxes;
+}
+
+uint32_t BoxFill::getFallbacks(void)
+{
+  return _fallbacks;
+}
+
+uint32_t BoxFill::getBytesPerSecond(void)
+{
+  return _micros > 0 ? (uint64_t)_bytes * 1000000 / _micros : 0;
+}
@@ -0,0 +1,42 @@
+#ifndef BoxFill_h
+#define BoxFill_h
+
+#include <Arduino.h>
+#include <U8g2lib.h>
+
+// Fills boxes in a vertical_top_lsb frame buffer one page at a time. The
+// rows of a box within a page form one byte mask, which is written four
+// columns at a time as a 32 bit word. Masks covering the whole page are
+// written with memset().
+class BoxFill
+{
+
+public:
+  BoxFill(void);
+
+  // Same pixels as u8g2_DrawBox(), u8g2_DrawHLine() and u8g2_DrawFrame()
+  // in the current draw color. Other buffer layouts and rotations and
+  // boxes that wrap around are drawn by u8g2.
+  void drawBox(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h);
+  void drawHLine(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w);
+  void drawFrame(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h);
+
+  uint32_t getBoxes(void);
+  uint32_t getFallbacks(void);
+  // Frame buffer bytes written per second, only measured in builds with
+  // DISPLAYSTATS
+  uint32_t getBytesPerSecond(void);
+
+protected:
+  uint32_t _boxes;
+  uint32_t _fallbacks;
+  uint32_t _bytes;
+  uint32_t _micros;
+
+  bool fill(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h);
+  void fillByte(uint8_t *target, uint8_t mask, uint8_t color);
+  void fillRow(uint8_t *target, uint8_t mask, uint16_t count, uint8_t color);
+
+};
+
+#endif
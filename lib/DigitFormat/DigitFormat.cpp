@@ -0,0 +1,53 @@
+#include "DigitFormat.h"
+
+const char DigitFormat::digitPairs[200] PROGMEM = {
+  '0','0', '0','1', '0','2', '0','3', '0','4', '0','5', '0','6', '0','7', '0','8', '0','9',
+  '1','0', '1','1', '1','2', '1','3', '1','4', '1','5', '1','6', '1','7', '1','8', '1','9',
+  '2','0', '2','1', '2','2', '2','3', '2','4', '2','5', '2','6', '2','7', '2','8', '2','9',
+  '3','0', '3','1', '3','2', '3','3', '3','4', '3','5', '3','6', '3','7', '3','8', '3','9',
+  '4','0', '4','1', '4','2', '4','3', '4','4', '4','5', '4','6', '4','7', '4','8', '4','9',
+  '5','0', '5','1', '5','2', '5','3', '5','4', '5','5', '5','6', '5','7', '5','8', '5','9',
+  '6','0', '6','1', '6','2', '6','3', '6','4', '6','5', '6','6', '6','7', '6','8', '6','9',
+  '7','0', '7','1', '7','2', '7','3', '7','4', '7','5', '7','6', '7','7', '7','8', '7','9',
+  '8','0', '8','1', '8','2', '8','3', '8','4', '8','5', '8','6', '8','7', '8','8', '8','9',
+  '9','0', '9','1', '9','2', '9','3', '9','4', '9','5', '9','6', '9','7', '9','8', '9','9'
+};
+
+char *DigitFormat::writeNumber(char *dest, uint8_t value)
+{
+  if (value >= 100) {
+    *dest++ = '0' + value / 100;
+    return writeTwoDigits(dest, value % 100);
+  }
+
+  if (value >= 10) {
+    return writeTwoDigits(dest, value);
+  }
+
+  *dest++ = '0' + value;
+  return dest;
+}
+
+char *DigitFormat::writeTwoDigits(char *dest, uint8_t value)
+{
+  // Wider values keep their last two digits
+  const char *pair = digitPairs + (value % 100) * 2;
+  *dest++ = pgm_read_byte(pair);
+  *dest++ = pgm_read_byte(pair + 1);
+  return dest;
+}
+
+char *DigitFormat::writeFourDigits(char *dest, uint16_t value)
+{
+  value = value % 10000;
+  dest = writeTwoDigits(dest, value / 100);
+  return writeTwoDigits(dest, value % 100);
+}
+
+char *DigitFormat::writeName(char *dest, const char *name)
+{
+  for (uint8_t i = 0; i < DIGIT_FORMAT_NAME_LENGTH && name[i] != '\0'; i++) {
+    *dest++ = name[i];
+  }
+  return dest;
+}
@@ -0,0 +1,74 @@
+#ifndef DigitFormat_h
+#define DigitFormat_h
+
+#include <Arduino.h>
+
+// Longest month and day name in the date line
+#define DIGIT_FORMAT_NAME_LENGTH 3
+
+// Buffer sizes including the terminating zero
+#define DIGIT_FORMAT_NUMBER_SIZE 4  // "255"
+#define DIGIT_FORMAT_TWO_SIZE    3  // "07"
+#define DIGIT_FORMAT_TIME_SIZE   6  // "07:05"
+#define DIGIT_FORMAT_DATE_SIZE   (DIGIT_FORMAT_NAME_LENGTH * 2 + 11) // "Jan 05 2019, SUN"
+
+// Replacement for the sprintf() calls on the render path. Digit pairs come
+// from a table, so a value is split with one division instead of the
+// subtraction loops of u8x8_u8toa(). The buffer size is checked at compile time.
+class DigitFormat
+{
+
+public:
+  // "%d"
+  template<size_t N>
+  static char *number(char (&dest)[N], uint8_t value) {
+    static_assert(N >= DIGIT_FORMAT_NUMBER_SIZE, "buffer too small for a number");
+    *writeNumber(dest, value) = '\0';
+    return dest;
+  }
+
+  // "%02d"
+  template<size_t N>
+  static char *twoDigits(char (&dest)[N], uint8_t value) {
+    static_assert(N >= DIGIT_FORMAT_TWO_SIZE, "buffer too small for two digits");
+    *writeTwoDigits(dest, value) = '\0';
+    return dest;
+  }
+
+  // "%02d:%02d"
+  template<size_t N>
+  static char *time(char (&dest)[N], uint8_t hour, uint8_t minute) {
+    static_assert(N >= DIGIT_FORMAT_TIME_SIZE, "buffer too small for the time");
+    char *p = writeTwoDigits(dest, hour);
+    *p++ = ':';
+    *writeTwoDigits(p, minute) = '\0';
+    return dest;
+  }
+
+  // "%s %02d %04d, %s", names are cut to DIGIT_FORMAT_NAME_LENGTH
+  template<size_t N>
+  static char *date(char (&dest)[N], const char *month, uint8_t day, uint16_t year, const char *weekday) {
+    static_assert(N >= DIGIT_FORMAT_DATE_SIZE, "buffer too small for the date");
+    char *p = writeName(dest, month);
+    *p++ = ' ';
+    p = writeTwoDigits(p, day);
+    *p++ = ' ';
+    p = writeFourDigits(p, year);
+    *p++ = ',';
+    *p++ = ' ';
+    *writeName(p, weekday) = '\0';
+    return dest;
+  }
+
+  // Unterminated writers, each returns the position after the last character
+  static char *writeNumber(char *dest, uint8_t value);
+  static char *writeTwoDigits(char *dest, uint8_t value);
+  static char *writeFourDigits(char *dest, uint16_t value);
+  static char *writeName(char *dest, const char *name);
+
+protected:
+  static const char digitPairs[200];
+
+};
+
+#endif
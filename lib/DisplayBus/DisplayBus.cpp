@@ -0,0 +1,89 @@
+#include "DisplayBus.h"
+
+uint8_t DisplayBus::_commandBytes = 0;
+
+void DisplayBus::begin(u8x8_t *u8x8)
+{
+  u8x8->cad_cb = cad;
+}
+
+void DisplayBus::endCommands(u8x8_t *u8x8)
+{
+  if (_commandBytes != 0) {
+    u8x8_byte_EndTransfer(u8x8);
+    _commandBytes = 0;
+  }
+}
+
+void DisplayBus::sendCommand(u8x8_t *u8x8, uint8_t command)
+{
+  if (_commandBytes >= DISPLAY_BUS_TRANSFER_SIZE) {
+    endCommands(u8x8);
+  }
+
+  if (_commandBytes == 0) {
+    u8x8_byte_StartTransfer(u8x8);
+    u8x8_byte_SendByte(u8x8, DISPLAY_BUS_COMMANDS);
+    _commandBytes = 1;
+  }
+
+  u8x8_byte_SendByte(u8x8, command);
+  _commandBytes++;
+}
+
+void DisplayBus::sendData(u8x8_t *u8x8, uint8_t length, uint8_t *data)
+{
+  const uint8_t chunkSize = DISPLAY_BUS_TRANSFER_SIZE - 1;
+  uint8_t chunks = (length + chunkSize - 1) / chunkSize;
+
+  endCommands(u8x8);
+
+  // Equal pieces, a 128 byte page goes as 64 + 64 rather than 127 + 1
+  while (chunks > 0) {
+    uint8_t size = (length + chunks - 1) / chunks;
+
+    u8x8_byte_StartTransfer(u8x8);
+    u8x8_byte_SendByte(u8x8, DISPLAY_BUS_DATA);
+    u8x8_byte_SendBytes(u8x8, size, data);
+    u8x8_byte_EndTransfer(u8x8);
+
+    data += size;
+    length -= size;
+    chunks--;
+  }
+}
+
+uint8_t DisplayBus::cad(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr)
+{
+  switch (msg) {
+    case U8X8_MSG_CAD_SEND_CMD:
+    case U8X8_MSG_CAD_SEND_ARG:
+      // In a command transaction arguments are command bytes as well
+      sendCommand(u8x8, arg_int);
+      break;
+
+    case U8X8_MSG_CAD_SEND_DATA:
+      sendData(u8x8, arg_int, (uint8_t *)arg_ptr);
+      break;
+
+    case U8X8_MSG_CAD_INIT:
+      // Default address, the start transfer message needs it
+      if (u8x8->i2c_address == 255) {
+        u8x8->i2c_address = 0x78;
+      }
+      return u8x8->byte_cb(u8x8, msg, arg_int, arg_ptr);
+
+    case U8X8_MSG_CAD_START_TRANSFER:
+      _commandBytes = 0;
+      break;
+
+    case U8X8_MSG_CAD_END_TRANSFER:
+      endCommands(u8x8);
+      break;
+
+    default:
+      return 0;
+  }
+
+  return 1;
+}
@@ -0,0 +1,37 @@
+#ifndef DisplayBus_h
+#define DisplayBus_h
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <U8g2lib.h>
+
+// Largest I2C transaction the Wire library can buffer, control byte included
+#define DISPLAY_BUS_TRANSFER_SIZE BUFFER_LENGTH
+
+// SSD13xx control bytes
+#define DISPLAY_BUS_COMMANDS 0x00
+#define DISPLAY_BUS_DATA     0x40
+
+// Replacement for u8x8_cad_ssd13xx_fast_i2c on the ESP8266. Consecutive
+// commands share one transaction and data is split into as few
+// transactions as the Wire buffer allows instead of 24 byte pieces.
+class DisplayBus
+{
+
+public:
+  // Must be called before u8g2.begin(), the init sequence already uses it
+  static void begin(u8x8_t *u8x8);
+
+  static uint8_t cad(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr);
+
+protected:
+  // Bytes in the open command transaction, 0 when none is open
+  static uint8_t _commandBytes;
+
+  static void sendCommand(u8x8_t *u8x8, uint8_t command);
+  static void sendData(u8x8_t *u8x8, uint8_t length, uint8_t *data);
+  static void endCommands(u8x8_t *u8x8);
+
+};
+
+#endif
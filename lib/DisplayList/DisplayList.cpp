@@ -0,0 +1,326 @@
+#include "DisplayList.h"
+
+// Coordinates stored for each command type
+static const uint8_t argCounts[] = { 1, 0, 1, 1, 4, 4, 3, 4, 5, 5, 4, 8, 2, 2 };
+
+DisplayList::DisplayList(void)
+{
+  _length = 0;
+  _overflow = true;
+  _previousLength = 0;
+  _previousHash = 0;
+  _recording = false;
+  _same = false;
+  _u8g2 = NULL;
+  _frames = 0;
+  _unchanged = 0;
+  _overflowCount = 0;
+  _replayed = 0;
+  _culled = 0;
+}
+
+void DisplayList::begin(u8g2_t *u8g2)
+{
+  _length = 0;
+  _overflow = false;
+  _u8g2 = u8g2;
+  _recording = true;
+
+  // Replay starts from the state the drawing code found
+  addColor(u8g2->draw_color);
+  if (u8g2->font != NULL) {
+    addFont(u8g2->font);
+  }
+  addFontMode(u8g2->font_decode.is_transparent);
+  #ifdef U8G2_WITH_FONT_ROTATION
+  addFontDirection(u8g2->font_decode.dir);
+  #endif
+}
+
+void DisplayList::end(void)
+{
+  _recording = false;
+
+  // A complete list is never empty, it starts with the color
+  uint32_t listHash = hash();
+  _same = !_overflow && _length == _previousLength && listHash == _previousHash;
+  _previousLength = _overflow ? 0 : _length;
+  _previousHash = listHash;
+
+  _frames++;
+  if (_same) {
+    _unchanged++;
+  }
+  if (_overflow) {
+    _overflowCount++;
+  }
+}
+
+// FNV-1a over the bytes of the list
+uint32_t DisplayList::hash(void)
+{
+  uint32_t h = 2166136261UL;
+
+  for (uint16_t i = 0; i < _length; i++) {
+    h = (h ^ _list[i]) * 16777619UL;
+  }
+  return h;
+}
+
+bool DisplayList::isRecording(void)
+{
+  return _recording;
+}
+
+bool DisplayList::isComplete(void)
+{
+  return !_overflow;
+}
+
+bool DisplayList::isUnchanged(void)
+{
+  return _same;
+}
+
+void DisplayList::addColor(uint8_t color)
+{
+  add(DISPLAY_COLOR, 0, 0, &color, 1, NULL, 0);
+}
+
+void DisplayList::addFont(const uint8_t *font)
+{
+  add(DISPLAY_FONT, 0, 0, NULL, 0, &font, sizeof(font));
+}
+
+void DisplayList::addFontMode(uint8_t mode)
+{
+  add(DISPLAY_FONT_MODE, 0, 0, &mode, 1, NULL, 0);
+}
+
+void DisplayList::addFontDirection(uint8_t direction)
+{
+  add(DISPLAY_FONT_DIRECTION, 0, 0, &direction, 1, NULL, 0);
+}
+
+void DisplayList::addLine(u8g2_uint_t x1, u8g2_uint_t y1, u8g2_uint_t x2, u8g2_uint_t y2)
+{
+  uint8_t args[4] = { x1, y1, x2, y2 };
+  uint8_t dx = x1 > x2 ? x1 - x2 : x2 - x1;
+  uint8_t dy = y1 > y2 ? y1 - y2 : y2 - y1;
+
+  // The error term of u8g2_DrawLine() overflows on long slanted lines, the
+  // rows are not bounded by the end points then
+  if (dx != 0 && dy != 0 && (dx > 127 || dy > 127)) {
+    add(DISPLAY_LINE, 0, 255, args, 4, NULL, 0);
+  } else if (y1 < y2) {
+    add(DISPLAY_LINE, y1, y2, args, 4, NULL, 0);
+  } else {
+    add(DISPLAY_LINE, y2, y1, args, 4, NULL, 0);
+  }
+}
+
+void DisplayList::addBox(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h)
+{
+  uint8_t args[4] = { x, y, w, h };
+  add(DISPLAY_BOX, y, y + h - 1, args, 4, NULL, 0);
+}
+
+void DisplayList::addHLine(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w)
+{
+  uint8_t args[3] = { x, y, w };
+  add(DISPLAY_HLINE, y, y, args, 3, NULL, 0);
+}
+
+void DisplayList::addFrame(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h)
+{
+  uint8_t args[4] = { x, y, w, h };
+  add(DISPLAY_FRAME, y, y + h - 1, args, 4, NULL, 0);
+}
+
+void DisplayList::addRBox(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h, u8g2_uint_t r)
+{
+  uint8_t args[5] = { x, y, w, h, r };
+  add(DISPLAY_RBOX, y, y + h - 1, args, 5, NULL, 0);
+}
+
+void DisplayList::addRFrame(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h, u8g2_uint_t r)
+{
+  uint8_t args[5] = { x, y, w, h, r };
+  add(DISPLAY_RFRAME, y, y + h - 1, args, 5, NULL, 0);
+}
+
+void DisplayList::addRing(u8g2_uint_t x0, u8g2_uint_t y0, u8g2_uint_t inner, u8g2_uint_t outer)
+{
+  uint8_t args[4] = { x0, y0, inner, outer };
+  add(DISPLAY_RING, (int16_t)y0 - outer, (int16_t)y0 + outer, args, 4, NULL, 0);
+}
+
+void DisplayList::addQuad(const uint8_t *x, const uint8_t *y)
+{
+  uint8_t args[8];
+  uint8_t top = y[0];
+  uint8_t bottom = y[0];
+
+  for (uint8_t i = 0; i < 4; i++) {
+    args[i] = x[i];
+    args[4 + i] = y[i];
+    if (y[i] < top) {
+      top = y[i];
+    }
+    if (y[i] > bottom) {
+      bottom = y[i];
+    }
+  }
+  add(DISPLAY_QUAD, top, bottom, args, 8, NULL, 0);
+}
+
+void DisplayList::addStr(u8g2_uint_t x, u8g2_uint_t y, const char *s)
+{
+  uint8_t args[2] = { x, y };
+  int16_t top;
+  int16_t bottom;
+
+  textRows(y, &top, &bottom);
+  add(DISPLAY_STR, top, bottom, args, 2, s, strlen(s) + 1);
+}
+
+void DisplayList::addGlyph(u8g2_uint_t x, u8g2_uint_t y, uint16_t encoding)
+{
+  uint8_t args[2] = { x, y };
+  int16_t top;
+  int16_t bottom;
+
+  textRows(y, &top, &bottom);
+  add(DISPLAY_GLYPH, top, bottom, args, 2, &encoding, sizeof(encoding));
+}
+
+// Rows of the font bounding box on the baseline y, see u8g2_DrawGlyph()
+void DisplayList::textRows(u8g2_uint_t y, int16_t *top, int16_t *bottom)
+{
+  #ifdef U8G2_WITH_FONT_ROTATION
+  if (_u8g2->font_decode.dir != 0) {
+    *top = 0;
+    *bottom = 255;
+    return;
+  }
+  #endif
+
+  int16_t baseline = (int16_t)y + (int8_t)_u8g2->font_calc_vref(_u8g2);
+  *top = baseline - (_u8g2->font_info.max_char_height + _u8g2->font_info.y_offset);
+  *bottom = baseline - _u8g2->font_info.y_offset - 1;
+}
+
+// Type, the first and last row for drawing commands, the coordinates and
+// size bytes of data. A list that runs full is marked and not replayed.
+void DisplayList::add(uint8_t type, int16_t top, int16_t bottom, const uint8_t *args, uint8_t count, const void *data, uint16_t size)
+{
+  if (!_recording || _overflow) {
+    return;
+  }
+
+  uint8_t *list = _list;
+  uint16_t length = _length;
+  uint16_t needed = 1 + (type >= DISPLAY_LINE ? 2 : 0) + count + size;
+
+  if (length + needed > DISPLAY_LIST_SIZE) {
+    _overflow = true;
+    return;
+  }
+
+  list[length++] = type;
+  if (type >= DISPLAY_LINE) {
+    // Rows outside 0..255 are never drawn, a command without rows gets an
+    // empty range
+    if (bottom < 0 || top > 255 || bottom < top) {
+      top = 255;
+      bottom = 0;
+    }
+    list[length++] = top < 0 ? 0 : top;
+    list[length++] = bottom > 255 ? 255 : bottom;
+  }
+  if (count > 0) {
+    memcpy(list + length, args, count);
+    length += count;
+  }
+  if (size > 0) {
+    memcpy(list + length, data, size);
+    length += size;
+  }
+
+  _length = length;
+}
+
+void DisplayList::replay(u8g2_t *u8g2, void (*execute)(const DisplayCommand &command))
+{
+  if (_overflow) {
+    return;
+  }
+
+  const uint8_t *list = _list;
+  const uint8_t *listEnd = list + _length;
+  uint8_t first = u8g2->pixel_curr_row;
+  uint8_t last = first + u8g2->pixel_buf_height - 1;
+  DisplayCommand command;
+
+  while (list < listEnd) {
+    command.type = *list++;
+
+    bool visible = true;
+    if (command.type >= DISPLAY_LINE) {
+      visible = list[1] >= first && list[0] <= last;
+      list += 2;
+    }
+
+    uint8_t count = argCounts[command.type];
+    memcpy(command.args, list, count);
+    list += count;
+
+    if (command.type == DISPLAY_FONT) {
+      memcpy(&command.font, list, sizeof(command.font));
+      list += sizeof(command.font);
+    } else if (command.type == DISPLAY_STR) {
+      command.str = (const char *)list;
+      list += strlen(command.str) + 1;
+    } else if (command.type == DISPLAY_GLYPH) {
+      memcpy(&command.encoding, list, sizeof(command.encoding));
+      list += sizeof(command.encoding);
+    }
+
+    if (!visible) {
+      _culled++;
+      continue;
+    }
+    execute(command);
+    _replayed++;
+  }
+}
+
+uint32_t DisplayList::getFrames(void)
+{
+  return _frames;
+}
+
+uint32_t DisplayList::getUnchanged(void)
+{
+  return _unchanged;
+}
+
+uint32_t DisplayList::getOverflows(void)
+{
+  return _overflowCount;
+}
+
+uint32_t DisplayList::getReplayed(void)
+{
+  return _replayed;
+}
+
+uint32_t DisplayList::getCulled(void)
+{
+  return _culled;
+}
+
+uint16_t DisplayList::getLength(void)
+{
+  return _length;
+}
@@ -0,0 +1,118 @@
+#ifndef DisplayList_h
+#define DisplayList_h
+
+#include <Arduino.h>
+#include <U8g2lib.h>
+
+// Bytes of the list, a frame with more commands is drawn without the list
+#define DISPLAY_LIST_SIZE 768
+
+// Most coordinates of a command, the four corners of a quad
+#define DISPLAY_LIST_MAX_ARGS 8
+
+// State commands, executed on every page
+#define DISPLAY_COLOR          0
+#define DISPLAY_FONT           1
+#define DISPLAY_FONT_MODE      2
+#define DISPLAY_FONT_DIRECTION 3
+
+// Drawing commands, executed on the pages their rows reach into
+#define DISPLAY_LINE   4
+#define DISPLAY_BOX    5
+#define DISPLAY_HLINE  6
+#define DISPLAY_FRAME  7
+#define DISPLAY_RBOX   8
+#define DISPLAY_RFRAME 9
+#define DISPLAY_RING   10
+#define DISPLAY_QUAD   11
+#define DISPLAY_STR    12
+#define DISPLAY_GLYPH  13
+
+// A recorded call with its arguments in the order of the draw call
+struct DisplayCommand {
+  uint8_t type;
+  uint8_t args[DISPLAY_LIST_MAX_ARGS];
+  // DISPLAY_FONT
+  const uint8_t *font;
+  // DISPLAY_STR, points into the list
+  const char *str;
+  // DISPLAY_GLYPH
+  uint16_t encoding;
+};
+
+// Records the draw calls of a frame once instead of running the drawing
+// code for every page. Each drawing command keeps the rows it can touch,
+// replay() executes only the commands that reach into the current page.
+// The length and a hash of the previous list are kept, so a frame that
+// would draw the same commands again can be left out before anything is
+// rasterized.
+class DisplayList
+{
+
+public:
+  DisplayList(void);
+
+  // Starts a new list with the current color and font state of u8g2
+  void begin(u8g2_t *u8g2);
+  void end(void);
+
+  bool isRecording(void);
+  // False when the commands did not fit
+  bool isComplete(void);
+  // True when the list is complete and has the length and hash of the
+  // previous one
+  bool isUnchanged(void);
+
+  void addColor(uint8_t color);
+  void addFont(const uint8_t *font);
+  void addFontMode(uint8_t mode);
+  void addFontDirection(uint8_t direction);
+
+  void addLine(u8g2_uint_t x1, u8g2_uint_t y1, u8g2_uint_t x2, u8g2_uint_t y2);
+  void addBox(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h);
+  void addHLine(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w);
+  void addFrame(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h);
+  void addRBox(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h, u8g2_uint_t r);
+  void addRFrame(u8g2_uint_t x, u8g2_uint_t y, u8g2_uint_t w, u8g2_uint_t h, u8g2_uint_t r);
+  void addRing(u8g2_uint_t x0, u8g2_uint_t y0, u8g2_uint_t inner, u8g2_uint_t outer);
+  void addQuad(const uint8_t *x, const uint8_t *y);
+  // The rows of text come from the current font of u8g2
+  void addStr(u8g2_uint_t x, u8g2_uint_t y, const char *s);
+  void addGlyph(u8g2_uint_t x, u8g2_uint_t y, uint16_t encoding);
+
+  // Calls execute() for the state commands and for the drawing commands
+  // that reach into the current page
+  void replay(u8g2_t *u8g2, void (*execute)(const DisplayCommand &command));
+
+  uint32_t getFrames(void);
+  uint32_t getUnchanged(void);
+  uint32_t getOverflows(void);
+  uint32_t getReplayed(void);
+  uint32_t getCulled(void);
+  // Bytes of the last list
+  uint16_t getLength(void);
+
+protected:
+  uint8_t _list[DISPLAY_LIST_SIZE];
+  uint16_t _length;
+  bool _overflow;
+  // 0 when the previous list was not complete
+  uint16_t _previousLength;
+  uint32_t _previousHash;
+  bool _recording;
+  bool _same;
+  u8g2_t *_u8g2;
+
+  uint32_t _frames;
+  uint32_t _unchanged;
+  uint32_t _overflowCount;
+  uint32_t _replayed;
+  uint32_t _culled;
+
+  void add(uint8_t type, int16_t top, int16_t bottom, const uint8_t *args, uint8_t count, const void *data, uint16_t size);
+  void textRows(u8g2_uint_t y, int16_t *top, int16_t *bottom);
+  uint32_t hash(void);
+
+};
+
+#endif
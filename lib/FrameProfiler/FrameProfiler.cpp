@@ -0,0 +1,124 @@
+#include "FrameProfiler.h"
+
+FrameProfiler::FrameProfiler(void)
+{
+  memset(_bytes, 0, sizeof(_bytes));
+  memset(_transactions, 0, sizeof(_transactions));
+  memset(_micros, 0, sizeof(_micros));
+  _frames = 0;
+}
+
+void FrameProfiler::record(uint16_t bytes, uint16_t transactions, uint32_t micros)
+{
+  uint8_t slot = _frames % FRAME_PROFILER_HISTORY;
+
+  _bytes[slot] = bytes;
+  _transactions[slot] = transactions;
+  _micros[slot] = micros;
+  _frames++;
+}
+
+uint32_t FrameProfiler::getFrames(void)
+{
+  return _frames;
+}
+
+uint8_t FrameProfiler::getFramesInHistory(void)
+{
+  return _frames < FRAME_PROFILER_HISTORY ? _frames : FRAME_PROFILER_HISTORY;
+}
+
+uint32_t FrameProfiler::getAverageMicros(void)
+{
+  uint8_t count = getFramesInHistory();
+  uint32_t sum = 0;
+
+  for (uint8_t i = 0; i < count; i++) {
+    sum += _micros[i];
+  }
+
+  return count > 0 ? sum / count : 0;
+}
+
+uint32_t FrameProfiler::getMaxMicros(void)
+{
+  uint8_t count = getFramesInHistory();
+  uint32_t result = 0;
+
+  for (uint8_t i = 0; i < count; i++) {
+    if (_micros[i] > result) {
+      result = _micros[i];
+    }
+  }
+
+  return result;
+}
+
+uint16_t FrameProfiler::getAverageBytes(void)
+{
+  uint8_t count = getFramesInHistory();
+  uint32_t sum = 0;
+
+  for (uint8_t i = 0; i < count; i++) {
+    sum += _bytes[i];
+  }
+
+  return count > 0 ? sum / count : 0;
+}
+
+uint16_t FrameProfiler::getAverageTransactions(void)
+{
+  uint8_t count = getFramesInHistory();
+  uint32_t sum = 0;
+
+  for (uint8_t i = 0; i < count; i++) {
+    sum += _transactions[i];
+  }
+
+  return count > 0 ? sum / count : 0;
+}
+
+uint8_t FrameProfiler::getBucket(uint8_t bucket)
+{
+  uint8_t count = getFramesInHistory();
+  uint8_t result = 0;
+
+  for (uint8_t i = 0; i < count; i++) {
+    uint32_t index = _micros[i] / FRAME_PROFILER_BUCKET_MICROS;
+
+    if (index >= FRAME_PROFILER_BUCKETS) {
+      index = FRAME_PROFILER_BUCKETS - 1;
+    }
+    if (index == bucket) {
+      result++;
+    }
+  }
+
+  return result;
+}
+
+String FrameProfiler::getReport(void)
+{
+  String result = "Frames: ";
+  result = result + String(_frames);
+  result = result + ", last ";
+  result = result + getFramesInHistory();
+  result = result + "\nBus time: ";
+  result = result + String(getAverageMicros());
+  result = result + " us average, ";
+  result = result + String(getMaxMicros());
+  result = result + " us max\nPer frame: ";
+  result = result + getAverageBytes();
+  result = result + " bytes, ";
+  result = result + getAverageTransactions();
+  result = result + " transactions\n";
+
+  for (uint8_t i = 0; i < FRAME_PROFILER_BUCKETS; i++) {
+    result = result + String((uint32_t)i * FRAME_PROFILER_BUCKET_MICROS / 1000);
+    result = result + (i == FRAME_PROFILER_BUCKETS - 1 ? "+ ms: " : " ms: ");
+    result = result + getBucket(i);
+    result = result + "\n";
+  }
+
+  return result;
+}
@@ -0,0 +1,43 @@
+#ifndef FrameProfiler_h
+#define FrameProfiler_h
+
+#include <Arduino.h>
+
+// Frames kept for the rolling statistics
+#define FRAME_PROFILER_HISTORY 32
+
+// Histogram of the bus time per frame, the last bucket collects the rest
+#define FRAME_PROFILER_BUCKETS 8
+#define FRAME_PROFILER_BUCKET_MICROS 2000
+
+// Keeps the bus bytes, transactions and time of the last frames
+class FrameProfiler
+{
+
+public:
+  FrameProfiler(void);
+
+  void record(uint16_t bytes, uint16_t transactions, uint32_t micros);
+
+  // Frames recorded since start, the statistics cover the last FRAME_PROFILER_HISTORY
+  uint32_t getFrames(void);
+  uint8_t getFramesInHistory(void);
+
+  uint32_t getAverageMicros(void);
+  uint32_t getMaxMicros(void);
+  uint16_t getAverageBytes(void);
+  uint16_t getAverageTransactions(void);
+  uint8_t getBucket(uint8_t bucket);
+
+  // Plain text report for Serial and the web server
+  String getReport(void);
+
+protected:
+  uint16_t _bytes[FRAME_PROFILER_HISTORY];
+  uint16_t _transactions[FRAME_PROFILER_HISTORY];
+  uint32_t _micros[FRAME_PROFILER_HISTORY];
+  uint32_t _frames;
+
+};
+
+#endif
@@ -0,0 +1,128 @@
+#include "GlyphBlitter.h"
+
+GlyphBlitter::GlyphBlitter(void)
+{
+  _alignedPages = 0;
+  _shiftedPages = 0;
+}
+
+bool GlyphBlitter::blit(u8g2_t *u8g2, u8g2_uint_t left, u8g2_uint_t top, uint8_t width, uint8_t height, const uint8_t *bitmap)
+{
+  if (u8g2->cb != &u8g2_cb_r0 || u8g2->ll_hvline != u8g2_ll_hvline_vertical_top_lsb) {
+    return false;
+  }
+  if (width == 0) {
+    return true;
+  }
+
+  // Clipped or wrapping bitmaps are drawn by u8g2
+  if (left < u8g2->user_x0 || left + width > u8g2->user_x1 || top + height > u8g2->height) {
+    return false;
+  }
+
+  #ifdef U8G2_WITH_CLIP_WINDOW_SUPPORT
+  if (u8g2->is_page_clip_window_intersection == 0) {
+    return true;
+  }
+  #endif
+
+  uint8_t color = u8g2->draw_color;
+  bool solid = !u8g2->font_decode.is_transparent;
+  uint16_t stride = u8g2_GetU8x8(u8g2)->display_info->tile_width * 8;
+  uint8_t pages = (height + 7) / 8;
+
+  for (uint8_t page = 0; page < pages; page++) {
+    int16_t row = top + page * 8;
+    uint8_t rows = height - page * 8;
+    uint8_t valid = rows >= 8 ? 0xFF : (1 << rows) - 1;
+
+    // Rows outside the user window of this buffer page are cut off
+    if (row < u8g2->user_y0 || row + 8 > u8g2->user_y1) {
+      for (int16_t r = row; r < row + 8; r++) {
+        if (r < u8g2->user_y0 || r >= u8g2->user_y1) {
+          valid &= ~(1 << (r - row));
+        }
+      }
+      if (valid == 0) {
+        continue;
+      }
+    }
+
+    int16_t bufferRow = row - u8g2->pixel_curr_row;
+    int8_t bufferPage = bufferRow >> 3;
+    uint8_t shift = bufferRow & 7;
+    const uint8_t *source = bitmap + page * width;
+    uint8_t *target = u8g2->tile_buf_ptr + bufferPage * stride + left;
+
+    if (shift == 0) {
+      writePage(target, source, width, 0, 0, valid, color, solid);
+      _alignedPages++;
+      continue;
+    }
+
+    // The lower rows of the bitmap page continue in the next buffer page
+    uint8_t first = valid << shift;
+    uint8_t second = valid >> (8 - shift);
+    if (bufferPage >= 0 && first != 0) {
+      writePage(target, source, width, shift, 0, first, color, solid);
+    }
+    if (second != 0) {
+      writePage(target + stride, source, width, shift, 8, second, color, solid);
+    }
+    _shiftedPages++;
+  }
+
+  return true;
+}
+
+// Writes the bitmap bytes shifted up by shift bits, bits high..high+7 of
+// the result, into the mask bits of the target. The background color is 1
+// for color 0 and 0 otherwise.
+void GlyphBlitter::writePage(uint8_t *target, const uint8_t *source, uint8_t width, uint8_t shift, uint8_t high, uint8_t mask, uint8_t color, bool solid)
+{
+  uint8_t keep = ~mask;
+  uint8_t x;
+
+  switch (color * 2 + solid) {
+    case 0:
+      for (x = 0; x < width; x++) {
+        target[x] &= ~((((uint16_t)source[x] << shift) >> high) & mask);
+      }
+      break;
+    case 1:
+      for (x = 0; x < width; x++) {
+        target[x] = (target[x] & keep) | (~(((uint16_t)source[x] << shift) >> high) & mask);
+      }
+      break;
+    case 2:
+      for (x = 0; x < width; x++) {
+        target[x] |= (((uint16_t)source[x] << shift) >> high) & mask;
+      }
+      break;
+    case 3:
+      for (x = 0; x < width; x++) {
+        target[x] = (target[x] & keep) | ((((uint16_t)source[x] << shift) >> high) & mask);
+      }
+      break;
+    case 4:
+      for (x = 0; x < width; x++) {
+        target[x] ^= (((uint16_t)source[x] << shift) >> high) & mask;
+      }
+      break;
+    default:
+      for (x = 0; x < width; x++) {
+        target[x] = (target[x] & keep) | (~target[x] & (((uint16_t)source[x] << shift) >> high) & mask);
+      }
+      break;
+  }
+}
+
+uint32_t GlyphBlitter::getAlignedPages(void)
+{
+  return _alignedPages;
+}
+
+uint32_t GlyphBlitter::getShiftedPages(void)
+{
+  return _shiftedPages;
+}
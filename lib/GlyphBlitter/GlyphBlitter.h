@@ -0,0 +1,34 @@
+#ifndef GlyphBlitter_h
+#define GlyphBlitter_h
+
+#include <Arduino.h>
+#include <U8g2lib.h>
+
+// Copies glyph bitmaps into a vertical_top_lsb frame buffer, 8 rows with
+// one byte operation. The bitmap has one byte per column and page like the
+// frame buffer. A bitmap page that starts on a buffer page is written to
+// that page only, otherwise it is shifted into two buffer pages.
+class GlyphBlitter
+{
+
+public:
+  GlyphBlitter(void);
+
+  // Draws the bitmap with its top left corner at left/top like the hvlines
+  // of u8g2_font_decode_glyph(), in the draw color and the font mode of
+  // u8g2. Returns false without drawing if the bitmap has to be drawn by
+  // u8g2: other rotation or buffer layout, or not completely on the screen.
+  bool blit(u8g2_t *u8g2, u8g2_uint_t left, u8g2_uint_t top, uint8_t width, uint8_t height, const uint8_t *bitmap);
+
+  uint32_t getAlignedPages(void);
+  uint32_t getShiftedPages(void);
+
+protected:
+  uint32_t _alignedPages;
+  uint32_t _shiftedPages;
+
+  void writePage(uint8_t *target, const uint8_t *source, uint8_t width, uint8_t shift, uint8_t high, uint8_t mask, uint8_t color, bool solid);
+
+};
+
+#endif
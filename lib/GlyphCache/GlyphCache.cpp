@@ -0,0 +1,265 @@
+#include "GlyphCache.h"
+#include <U8g2Font.h>
+
+GlyphCache::GlyphCache(void)
+{
+  _fontCount = 0;
+  _hits = 0;
+  _misses = 0;
+  _hitMicros = 0;
+  _missMicros = 0;
+  _uncached = 0;
+  clear();
+}
+
+void GlyphCache::addFont(const uint8_t *font, const uint8_t *raw)
+{
+  if (_fontCount >= GLYPH_CACHE_FONTS || findFont(font) != NULL) {
+    return;
+  }
+
+  _fonts[_fontCount].font = font;
+  _fonts[_fontCount].raw = raw;
+  _fontCount++;
+}
+
+void GlyphCache::clear(void)
+{
+  for (uint8_t i = 0; i < GLYPH_CACHE_ENTRIES; i++) {
+    _entries[i].font = NULL;
+    _entries[i].lastUse = 0;
+  }
+  _uses = 0;
+}
+
+GlyphCache::CachedFont *GlyphCache::findFont(const uint8_t *font)
+{
+  for (uint8_t i = 0; i < _fontCount; i++) {
+    if (_fonts[i].font == font) {
+      return &_fonts[i];
+    }
+  }
+  return NULL;
+}
+
+GlyphCache::Entry *GlyphCache::find(const uint8_t *font, uint16_t encoding)
+{
+  for (uint8_t i = 0; i < GLYPH_CACHE_ENTRIES; i++) {
+    if (_entries[i].font == font && _entries[i].encoding == encoding) {
+      return &_entries[i];
+    }
+  }
+  return NULL;
+}
+
+bool GlyphCache::draw(u8g2_t *u8g2, const uint8_t *glyphData, uint16_t encoding, int8_t *advance)
+{
+  if (u8g2->cb != &u8g2_cb_r0 || u8g2->ll_hvline != u8g2_ll_hvline_vertical_top_lsb) {
+    return false;
+  }
+  #ifdef U8G2_WITH_FONT_ROTATION
+  if (u8g2->font_decode.dir != 0) {
+    return false;
+  }
+  #endif
+
+  // Glyphs of other fonts are decoded every time but still blitted
+  CachedFont *font = findFont(u8g2->font);
+  if (font == NULL) {
+    if (!decode(u8g2, glyphData, &_scratch) || !blit(u8g2, &_scratch)) {
+      return false;
+    }
+    *advance = _scratch.advance;
+    _uncached++;
+    return true;
+  }
+
+  #ifdef DISPLAYSTATS
+  uint32_t start = micros();
+  #endif
+  Entry *entry = find(u8g2->font, encoding);
+  bool hit = entry != NULL;
+
+  if (!hit) {
+    entry = &_entries[0];
+    for (uint8_t i = 1; i < GLYPH_CACHE_ENTRIES; i++) {
+      if (_entries[i].lastUse < entry->lastUse) {
+        entry = &_entries[i];
+      }
+    }
+
+    if (!(font->raw != NULL && load(font->raw, encoding, entry)) && !decode(u8g2, glyphData, entry)) {
+      entry->font = NULL;
+      entry->lastUse = 0;
+      return false;
+    }
+    entry->font = u8g2->font;
+    entry->encoding = encoding;
+  }
+  entry->lastUse = ++_uses;
+
+  if (!blit(u8g2, entry)) {
+    return false;
+  }
+  *advance = entry->advance;
+
+  if (hit) {
+    _hits++;
+    #ifdef DISPLAYSTATS
+    _hitMicros += micros() - start;
+    #endif
+  } else {
+    _misses++;
+    #ifdef DISPLAYSTATS
+    _missMicros += micros() - start;
+    #endif
+  }
+  return true;
+}
+
+// The RLE format of u8g2_font_decode_glyph(): pairs of background and
+// foreground run lengths, each pair can be repeated, rows wrap at the
+// glyph width
+bool GlyphCache::decode(u8g2_t *u8g2, const uint8_t *glyphData, Entry *entry)
+{
+  u8g2_font_decode_t decode;
+  const u8g2_font_info_t *info = &u8g2->font_info;
+
+  decode.decode_ptr = glyphData;
+  decode.decode_bit_pos = 0;
+
+  entry->width = u8g2_font_decode_get_unsigned_bits(&decode, info->bits_per_char_width);
+  entry->height = u8g2_font_decode_get_unsigned_bits(&decode, info->bits_per_char_height);
+  entry->offsetX = u8g2_font_decode_get_signed_bits(&decode, info->bits_per_char_x);
+  entry->offsetY = u8g2_font_decode_get_signed_bits(&decode, info->bits_per_char_y);
+  entry->advance = u8g2_font_decode_get_signed_bits(&decode, info->bits_per_delta_x);
+
+  uint8_t width = entry->width;
+  uint8_t height = entry->height;
+  if (width * ((height + 7) / 8) > GLYPH_CACHE_BITMAP_SIZE) {
+    return false;
+  }
+  memset(entry->bitmap, 0, sizeof(entry->bitmap));
+
+  if (width == 0) {
+    return true;
+  }
+
+  uint8_t x = 0;
+  uint8_t y = 0;
+  while (y < height) {
+    uint8_t runs[2];
+    runs[0] = u8g2_font_decode_get_unsigned_bits(&decode, info->bits_per_0);
+    runs[1] = u8g2_font_decode_get_unsigned_bits(&decode, info->bits_per_1);
+
+    do {
+      for (uint8_t foreground = 0; foreground < 2; foreground++) {
+        uint8_t length = runs[foreground];
+
+        while (length > 0) {
+          uint8_t count = width - x;
+          if (count > length) {
+            count = length;
+          }
+
+          if (foreground && y < height) {
+            uint8_t *column = entry->bitmap + (y >> 3) * width + x;
+            uint8_t mask = 1 << (y & 7);
+            for (uint8_t i = 0; i < count; i++) {
+              column[i] |= mask;
+            }
+          }
+
+          x += count;
+          length -= count;
+          if (x == width) {
+            x = 0;
+            y++;
+          }
+        }
+      }
+    } while (u8g2_font_decode_get_unsigned_bits(&decode, 1) != 0);
+  }
+
+  return true;
+}
+
+// Copies a glyph from a raw table, false if the table does not have it
+bool GlyphCache::load(const uint8_t *raw, uint16_t encoding, Entry *entry)
+{
+  uint8_t count = u8x8_pgm_read(raw++);
+
+  for (uint8_t i = 0; i < count; i++) {
+    uint8_t width = u8x8_pgm_read(raw + 1);
+    uint8_t height = u8x8_pgm_read(raw + 2);
+    uint16_t size = width * ((height + 7) / 8);
+
+    if (u8x8_pgm_read(raw) == encoding) {
+      if (size > GLYPH_CACHE_BITMAP_SIZE) {
+        return false;
+      }
+
+      entry->width = width;
+      entry->height = height;
+      entry->offsetX = (int8_t)u8x8_pgm_read(raw + 3);
+      entry->offsetY = (int8_t)u8x8_pgm_read(raw + 4);
+      entry->advance = (int8_t)u8x8_pgm_read(raw + 5);
+      for (uint16_t j = 0; j < size; j++) {
+        entry->bitmap[j] = u8x8_pgm_read(raw + 6 + j);
+      }
+      return true;
+    }
+
+    raw += 6 + size;
+  }
+
+  return false;
+}
+
+// Same pixels as the hvlines of u8g2_font_decode_len()
+bool GlyphCache::blit(u8g2_t *u8g2, const Entry *entry)
+{
+  u8g2_font_decode_t *decode = &u8g2->font_decode;
+  u8g2_uint_t left = decode->target_x + entry->offsetX;
+  u8g2_uint_t top = decode->target_y - (entry->height + entry->offsetY);
+
+  if (!_blitter.blit(u8g2, left, top, entry->width, entry->height, entry->bitmap)) {
+    return false;
+  }
+
+  if (entry->width != 0) {
+    decode->target_x = left;
+    decode->target_y = top;
+  }
+  return true;
+}
+
+uint32_t GlyphCache::getHits(void)
+{
+  return _hits;
+}
+
+uint32_t GlyphCache::getMisses(void)
+{
+  return _misses;
+}
+
+uint32_t GlyphCache::getUncached(void)
+{
+  return _uncached;
+}
+
+GlyphBlitter *GlyphCache::getBlitter(void)
+{
+  return &_blitter;
+}
+
+uint32_t GlyphCache::getHitMicros(void)
+{
+  return _hits > 0 ? _hitMicros / _hits : 0;
+}
+
+uint32_t GlyphCache::getMissMicros(void)
+{
+  return _misses > 0 ? _missMicros / _misses : 0;
+}
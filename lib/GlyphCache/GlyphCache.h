@@ -0,0 +1,91 @@
+#ifndef GlyphCache_h
+#define GlyphCache_h
+
+#include <Arduino.h>
+#include <U8g2lib.h>
+#include <GlyphBlitter.h>
+
+// Fonts whose glyphs are cached
+#define GLYPH_CACHE_FONTS 4
+
+// Decoded glyphs kept, the least recently used one is replaced
+#define GLYPH_CACHE_ENTRIES 16
+
+// Bitmap bytes per glyph, larger glyphs are not cached
+#define GLYPH_CACHE_BITMAP_SIZE 48
+
+// Keeps decoded glyphs of the registered fonts as column bitmaps, one byte
+// per column and page like the frame buffer, and copies them into the
+// frame buffer instead of decoding the RLE data again. A font can come with
+// a raw table of these bitmaps in flash, then a miss is a copy instead of a
+// decode. Glyphs of other fonts are decoded into a bitmap for every draw and
+// copied the same way. Glyphs that are not completely on the screen,
+// rotated output and other buffer layouts are left to the u8g2 decoder.
+class GlyphCache
+{
+
+public:
+  GlyphCache(void);
+
+  // raw: glyph count, then per glyph encoding, width, height, x and y
+  // offset, advance and the bitmap, see scripts/subset_fonts.py
+  void addFont(const uint8_t *font, const uint8_t *raw = NULL);
+  void clear(void);
+
+  // Draws a glyph of the current font at font_decode.target_x/target_y like
+  // u8g2_font_decode_glyph(). Returns false if the glyph has to be decoded
+  // by u8g2 instead.
+  bool draw(u8g2_t *u8g2, const uint8_t *glyphData, uint16_t encoding, int8_t *advance);
+
+  uint32_t getHits(void);
+  uint32_t getMisses(void);
+  // Glyphs of fonts that are not cached
+  uint32_t getUncached(void);
+  GlyphBlitter *getBlitter(void);
+
+  // Average draw time of a cached and of a newly decoded glyph, only
+  // measured in builds with DISPLAYSTATS
+  uint32_t getHitMicros(void);
+  uint32_t getMissMicros(void);
+
+protected:
+  struct Entry {
+    const uint8_t *font;
+    uint16_t encoding;
+    uint32_t lastUse;
+    uint8_t width;
+    uint8_t height;
+    int8_t offsetX;
+    int8_t offsetY;
+    int8_t advance;
+    uint8_t bitmap[GLYPH_CACHE_BITMAP_SIZE];
+  };
+
+  struct CachedFont {
+    const uint8_t *font;
+    const uint8_t *raw;
+  };
+
+  CachedFont _fonts[GLYPH_CACHE_FONTS];
+  uint8_t _fontCount;
+
+  Entry _entries[GLYPH_CACHE_ENTRIES];
+  Entry _scratch;
+  uint32_t _uses;
+  GlyphBlitter _blitter;
+
+  uint32_t _hits;
+  uint32_t _misses;
+  uint32_t _hitMicros;
+  uint32_t _missMicros;
+  uint32_t _uncached;
+
+  CachedFont *findFont(const uint8_t *font);
+  Entry *find(const uint8_t *font, uint16_t encoding);
+  bool decode(u8g2_t *u8g2, const uint8_t *glyphData, Entry *entry);
+  bool load(const uint8_t *raw, uint16_t encoding, Entry *entry);
+  bool blit(u8g2_t *u8g2, const Entry *entry);
+
+};
+
+#endif
@@ -0,0 +1,192 @@
+#include "GlyphIndex.h"
+#include <U8g2Font.h>
+
+// Size of the font header in front of the glyph list, see u8g2_font.c
+#define GLYPH_INDEX_FONT_HEADER_SIZE 23
+
+GlyphIndex::GlyphIndex(void)
+{
+  _lookups = 0;
+  _fallbacks = 0;
+  _builds = 0;
+  _cache = NULL;
+  clear();
+}
+
+void GlyphIndex::setCache(GlyphCache *cache)
+{
+  _cache = cache;
+}
+
+void GlyphIndex::clear(void)
+{
+  for (uint8_t i = 0; i < GLYPH_INDEX_FONTS; i++) {
+    _slots[i].font = NULL;
+    _slots[i].lastUse = 0;
+  }
+  _current = NULL;
+  _uses = 0;
+}
+
+GlyphIndex::Slot *GlyphIndex::findSlot(const uint8_t *font)
+{
+  if (_current != NULL && _current->font == font) {
+    return _current;
+  }
+
+  Slot *oldest = &_slots[0];
+  for (uint8_t i = 0; i < GLYPH_INDEX_FONTS; i++) {
+    if (_slots[i].font == font) {
+      _current = &_slots[i];
+      _current->lastUse = ++_uses;
+      return _current;
+    }
+    if (_slots[i].lastUse < oldest->lastUse) {
+      oldest = &_slots[i];
+    }
+  }
+
+  build(oldest, font);
+  _current = oldest;
+  _current->lastUse = ++_uses;
+  return _current;
+}
+
+// Walks the glyph list once, like u8g2_font_get_glyph_data() does for
+// every glyph
+void GlyphIndex::build(Slot *slot, const uint8_t *font)
+{
+  const uint8_t *glyph = font + GLYPH_INDEX_FONT_HEADER_SIZE;
+
+  slot->font = font;
+  for (uint8_t i = 0; i <= GLYPH_INDEX_LAST - GLYPH_INDEX_FIRST; i++) {
+    slot->offsets[i] = GLYPH_INDEX_MISSING;
+  }
+
+  for (;;) {
+    uint8_t size = u8x8_pgm_read(glyph + 1);
+    if (size == 0) {
+      break;
+    }
+
+    uint8_t encoding = u8x8_pgm_read(glyph);
+    if (encoding >= GLYPH_INDEX_FIRST && encoding <= GLYPH_INDEX_LAST) {
+      // Skip encoding and glyph size
+      uint32_t offset = glyph + 2 - font;
+      slot->offsets[encoding - GLYPH_INDEX_FIRST] = offset < GLYPH_INDEX_TOO_FAR ? offset : GLYPH_INDEX_TOO_FAR;
+    }
+    glyph += size;
+  }
+
+  _builds++;
+}
+
+const uint8_t *GlyphIndex::getGlyphData(u8g2_t *u8g2, uint16_t encoding)
+{
+  if (encoding >= GLYPH_INDEX_FIRST && encoding <= GLYPH_INDEX_LAST) {
+    Slot *slot = findSlot(u8g2->font);
+    uint16_t offset = slot->offsets[encoding - GLYPH_INDEX_FIRST];
+
+    if (offset == GLYPH_INDEX_MISSING) {
+      _lookups++;
+      return NULL;
+    }
+    if (offset != GLYPH_INDEX_TOO_FAR) {
+      _lookups++;
+      return u8g2->font + offset;
+    }
+  }
+
+  _fallbacks++;
+  return u8g2_font_get_glyph_data(u8g2, encoding);
+}
+
+// u8g2_font_draw_glyph(), y is the baseline
+u8g2_uint_t GlyphIndex::drawGlyphAt(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, uint16_t encoding)
+{
+  u8g2->font_decode.target_x = x;
+  u8g2->font_decode.target_y = y;
+
+  const uint8_t *glyphData = getGlyphData(u8g2, encoding);
+  if (glyphData == NULL) {
+    return 0;
+  }
+
+  int8_t advance;
+  if (_cache != NULL && _cache->draw(u8g2, glyphData, encoding, &advance)) {
+    return advance;
+  }
+  return u8g2_font_decode_glyph(u8g2, glyphData);
+}
+
+u8g2_uint_t GlyphIndex::drawGlyph(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, uint16_t encoding)
+{
+  #ifdef U8G2_WITH_FONT_ROTATION
+  switch (u8g2->font_decode.dir) {
+    case 0:
+      y += u8g2->font_calc_vref(u8g2);
+      break;
+    case 1:
+      x -= u8g2->font_calc_vref(u8g2);
+      break;
+    case 2:
+      y -= u8g2->font_calc_vref(u8g2);
+      break;
+    case 3:
+      x += u8g2->font_calc_vref(u8g2);
+      break;
+  }
+  #else
+  y += u8g2->font_calc_vref(u8g2);
+  #endif
+
+  return drawGlyphAt(u8g2, x, y, encoding);
+}
+
+// u8g2_DrawStr(): one byte per glyph, a line feed ends the string
+u8g2_uint_t GlyphIndex::drawStr(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, const char *s)
+{
+  u8g2_uint_t sum = 0;
+
+  for (; *s != '\0' && *s != '\n'; s++) {
+    u8g2_uint_t delta = drawGlyph(u8g2, x, y, (uint8_t)*s);
+
+    #ifdef U8G2_WITH_FONT_ROTATION
+    switch (u8g2->font_decode.dir) {
+      case 0:
+        x += delta;
+        break;
+      case 1:
+        y += delta;
+        break;
+      case 2:
+        x -= delta;
+        break;
+      case 3:
+        y -= delta;
+        break;
+    }
+    #else
+    x += delta;
+    #endif
+
+    sum += delta;
+  }
+
+  return sum;
+}
+
+uint32_t GlyphIndex::getLookups(void)
+{
+  return _lookups;
+}
+
+uint32_t GlyphIndex::getFallbacks(void)
+{
+  return _fallbacks;
+}
+
+uint32_t GlyphIndex::getBuilds(void)
+{
+  return _builds;
+}
@@ -0,0 +1,67 @@
+#ifndef GlyphIndex_h
+#define GlyphIndex_h
+
+#include <Arduino.h>
+#include <U8g2lib.h>
+#include <GlyphCache.h>
+
+// Fonts indexed at the same time, the least recently used one is replaced
+#define GLYPH_INDEX_FONTS 4
+
+// Encodings held in the index, others are searched by u8g2
+#define GLYPH_INDEX_FIRST 32
+#define GLYPH_INDEX_LAST 127
+
+// Offset values that are no glyph offsets
+#define GLYPH_INDEX_MISSING 0x0000
+#define GLYPH_INDEX_TOO_FAR 0xFFFF
+
+// Finds glyph data with one table lookup instead of walking the glyph list
+// of the font in flash. The table of a font is built on its first use.
+// drawStr() and drawGlyph() draw exactly like u8g2_DrawStr() and
+// u8g2_DrawGlyph().
+class GlyphIndex
+{
+
+public:
+  GlyphIndex(void);
+
+  void clear(void);
+
+  // Glyphs of the cached fonts are drawn from the cache
+  void setCache(GlyphCache *cache);
+
+  // Same result as u8g2_font_get_glyph_data() for the current font
+  const uint8_t *getGlyphData(u8g2_t *u8g2, uint16_t encoding);
+
+  u8g2_uint_t drawStr(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, const char *s);
+  u8g2_uint_t drawGlyph(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, uint16_t encoding);
+
+  uint32_t getLookups(void);
+  uint32_t getFallbacks(void);
+  uint32_t getBuilds(void);
+
+protected:
+  struct Slot {
+    const uint8_t *font;
+    uint32_t lastUse;
+    // Glyph data offsets from the start of the font
+    uint16_t offsets[GLYPH_INDEX_LAST - GLYPH_INDEX_FIRST + 1];
+  };
+
+  Slot _slots[GLYPH_INDEX_FONTS];
+  Slot *_current;
+  GlyphCache *_cache;
+  uint32_t _uses;
+
+  uint32_t _lookups;
+  uint32_t _fallbacks;
+  uint32_t _builds;
+
+  Slot *findSlot(const uint8_t *font);
+  void build(Slot *slot, const uint8_t *font);
+  u8g2_uint_t drawGlyphAt(u8g2_t *u8g2, u8g2_uint_t x, u8g2_uint_t y, uint16_t encoding);
+
+};
+
+#endif
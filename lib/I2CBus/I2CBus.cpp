@@ -0,0 +1,166 @@
+#include "I2CBus.h"
+
+I2CBus *I2CBus::_displayBus = NULL;
+
+I2CBus::I2CBus(void)
+{
+  _deviceCount = 0;
+  _currentClock = 0;
+  _display = I2C_BUS_NO_DEVICE;
+  _transactionStart = 0;
+  _frameOpen = false;
+  _deferredCount = 0;
+  resetStats();
+}
+
+uint8_t I2CBus::addDevice(uint8_t address, uint32_t clock)
+{
+  if (_deviceCount >= I2C_BUS_MAX_DEVICES) {
+    return I2C_BUS_NO_DEVICE;
+  }
+
+  _addresses[_deviceCount] = address;
+  _clocks[_deviceCount] = clock;
+  return _deviceCount++;
+}
+
+uint8_t I2CBus::attachDisplay(u8x8_t *u8x8, uint32_t clock)
+{
+  // u8x8 keeps the 8 bit address, 255 means the controller default
+  uint8_t address = u8x8->i2c_address == 255 ? 0x3C : u8x8->i2c_address >> 1;
+
+  _display = addDevice(address, clock);
+  _displayBus = this;
+  u8x8->bus_clock = clock;
+  u8x8->byte_cb = displayByte;
+  return _display;
+}
+
+void I2CBus::setClock(uint32_t clock)
+{
+  if (clock != _currentClock) {
+    Wire.setClock(clock);
+    _currentClock = clock;
+  }
+}
+
+void I2CBus::beginTransaction(uint8_t device)
+{
+  setClock(_clocks[device]);
+  _transactionStart = micros();
+}
+
+void I2CBus::endTransaction(uint8_t device, uint16_t bytes, uint8_t transactions)
+{
+  _stats[device].transactions += transactions;
+  _stats[device].bytes += bytes;
+  _stats[device].micros += micros() - _transactionStart;
+}
+
+void I2CBus::beginFrame(void)
+{
+  _frameOpen = true;
+}
+
+void I2CBus::endFrame(void)
+{
+  _frameOpen = false;
+
+  // A callback may open a frame again, the rest waits for it
+  while (_deferredCount > 0 && !_frameOpen) {
+    void (*callback)(void) = _deferred[0];
+
+    _deferredCount--;
+    memmove(_deferred, _deferred + 1, _deferredCount * sizeof(_deferred[0]));
+    callback();
+  }
+}
+
+bool I2CBus::isFrameOpen(void)
+{
+  return _frameOpen;
+}
+
+bool I2CBus::runOutsideFrame(void (*callback)(void))
+{
+  if (!_frameOpen) {
+    callback();
+    return true;
+  }
+
+  // The same work queued twice would only repeat the transaction
+  for (uint8_t i = 0; i < _deferredCount; i++) {
+    if (_deferred[i] == callback) {
+      return true;
+    }
+  }
+
+  if (_deferredCount >= I2C_BUS_MAX_DEFERRED) {
+    return false;
+  }
+
+  _deferred[_deferredCount++] = callback;
+  return true;
+}
+
+uint8_t I2CBus::getDeviceCount(void)
+{
+  return _deviceCount;
+}
+
+uint8_t I2CBus::getAddress(uint8_t device)
+{
+  return _addresses[device];
+}
+
+const I2CDeviceStats &I2CBus::getStats(uint8_t device)
+{
+  return _stats[device];
+}
+
+void I2CBus::resetStats(void)
+{
+  memset(_stats, 0, sizeof(_stats));
+}
+
+uint8_t I2CBus::displayByte(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr)
+{
+  I2CBus *bus = _displayBus;
+
+  switch (msg) {
+    case U8X8_MSG_BYTE_SEND:
+      Wire.write((uint8_t *)arg_ptr, (int)arg_int);
+      bus->_stats[bus->_display].bytes += arg_int;
+      break;
+
+    case U8X8_MSG_BYTE_INIT:
+      if (u8x8->pins[U8X8_PIN_I2C_CLOCK] != U8X8_PIN_NONE && u8x8->pins[U8X8_PIN_I2C_DATA] != U8X8_PIN_NONE) {
+        Wire.begin(u8x8->pins[U8X8_PIN_I2C_DATA], u8x8->pins[U8X8_PIN_I2C_CLOCK]);
+      } else {
+        Wire.begin();
+      }
+      // Wire.begin() sets its own default clock
+      bus->_currentClock = 0;
+      break;
+
+    case U8X8_MSG_BYTE_SET_DC:
+      break;
+
+    case U8X8_MSG_BYTE_START_TRANSFER:
+      bus->setClock(u8x8->bus_clock);
+      bus->_transactionStart = micros();
+      Wire.beginTransmission(u8x8_GetI2CAddress(u8x8) >> 1);
+      break;
+
+    case U8X8_MSG_BYTE_END_TRANSFER:
+      Wire.endTransmission();
+      bus->_stats[bus->_display].transactions++;
+      bus->_stats[bus->_display].micros += micros() - bus->_transactionStart;
+      break;
+
+    default:
+      return 0;
+  }
+
+  return 1;
+}
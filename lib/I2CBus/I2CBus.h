@@ -0,0 +1,76 @@
+#ifndef I2CBus_h
+#define I2CBus_h
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <U8g2lib.h>
+
+#define I2C_BUS_MAX_DEVICES 4
+#define I2C_BUS_MAX_DEFERRED 4
+
+#define I2C_BUS_NO_DEVICE 0xFF
+
+struct I2CDeviceStats {
+  uint32_t transactions;
+  uint32_t bytes;
+  uint32_t micros;
+};
+
+// Owns the Wire bus shared by the display and the other devices. The clock
+// is changed only when the next transaction is for a device with another
+// clock, and work for other devices is held back while a frame is sent.
+class I2CBus
+{
+
+public:
+  I2CBus(void);
+
+  // Returns the device id or I2C_BUS_NO_DEVICE when the table is full
+  uint8_t addDevice(uint8_t address, uint32_t clock);
+
+  // Routes the display through the bus, must be called before u8g2.begin()
+  uint8_t attachDisplay(u8x8_t *u8x8, uint32_t clock);
+
+  // Plain Wire transactions of other devices are wrapped in these. One
+  // pair may wrap several transactions, like a register write and a read.
+  void beginTransaction(uint8_t device);
+  void endTransaction(uint8_t device, uint16_t bytes, uint8_t transactions = 1);
+
+  // Keeps deferred work off the bus until the frame is complete
+  void beginFrame(void);
+  void endFrame(void);
+  bool isFrameOpen(void);
+
+  // Runs the callback now, or after the current frame. Returns false
+  // when the queue is full and the callback was dropped.
+  bool runOutsideFrame(void (*callback)(void));
+
+  uint8_t getDeviceCount(void);
+  uint8_t getAddress(uint8_t device);
+  const I2CDeviceStats &getStats(uint8_t device);
+  void resetStats(void);
+
+  // u8x8 byte callback, replaces u8x8_byte_arduino_hw_i2c
+  static uint8_t displayByte(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr);
+
+protected:
+  static I2CBus *_displayBus;
+
+  uint8_t _addresses[I2C_BUS_MAX_DEVICES];
+  uint32_t _clocks[I2C_BUS_MAX_DEVICES];
+  I2CDeviceStats _stats[I2C_BUS_MAX_DEVICES];
+  uint8_t _deviceCount;
+
+  uint32_t _currentClock;
+  uint8_t _display;
+  uint32_t _transactionStart;
+  bool _frameOpen;
+
+  void (*_deferred[I2C_BUS_MAX_DEFERRED])(void);
+  uint8_t _deferredCount;
+
+  void setClock(uint32_t clock);
+
+};
+
+#endif
@@ -0,0 +1,197 @@
+#include "LineRasterizer.h"
+
+LineRasterizer::LineRasterizer(void)
+{
+  _lines = 0;
+  _fallbacks = 0;
+  _micros = 0;
+}
+
+void LineRasterizer::write(uint8_t *target, uint8_t bits, uint8_t color)
+{
+  if (color == 0) {
+    *target &= ~bits;
+  } else if (color == 1) {
+    *target |= bits;
+  } else {
+    *target ^= bits;
+  }
+}
+
+void LineRasterizer::drawLine(u8g2_t *u8g2, u8g2_uint_t x1, u8g2_uint_t y1, u8g2_uint_t x2, u8g2_uint_t y2)
+{
+  // Major axis first and from left to right, like u8g2_DrawLine()
+  int16_t major1 = x1;
+  int16_t minor1 = y1;
+  int16_t major2 = x2;
+  int16_t minor2 = y2;
+  int16_t dx = major1 > major2 ? major1 - major2 : major2 - major1;
+  int16_t dy = minor1 > minor2 ? minor1 - minor2 : minor2 - minor1;
+  bool swapxy = dy > dx;
+  int16_t tmp;
+
+  if (swapxy) {
+    tmp = dx; dx = dy; dy = tmp;
+    major1 = y1; minor1 = x1;
+    major2 = y2; minor2 = x2;
+  }
+  if (major1 > major2) {
+    tmp = major1; major1 = major2; major2 = tmp;
+    tmp = minor1; minor1 = minor2; minor2 = tmp;
+  }
+
+  // The error term of u8g2 is a u8g2_int_t, longer slanted lines overflow
+  // it and are left to u8g2 to get the same pixels
+  if (u8g2->cb != &u8g2_cb_r0 || u8g2->ll_hvline != u8g2_ll_hvline_vertical_top_lsb || (dy != 0 && dx > 127)) {
+    _fallbacks++;
+    u8g2_DrawLine(u8g2, x1, y1, x2, y2);
+    return;
+  }
+
+  _lines++;
+
+  #ifdef DISPLAYSTATS
+  uint32_t start = micros();
+  #endif
+
+  rasterize(u8g2, major1, minor1, major2, minor2, dx, dy, swapxy);
+
+  #ifdef DISPLAYSTATS
+  _micros += micros() - start;
+  #endif
+}
+
+// Major and minor coordinates with major1 <= major2
+void LineRasterizer::rasterize(u8g2_t *u8g2, int16_t major1, int16_t minor1, int16_t major2, int16_t minor2, int16_t dx, int16_t dy, bool swapxy)
+{
+  #ifdef U8G2_WITH_CLIP_WINDOW_SUPPORT
+  if (u8g2->is_page_clip_window_intersection == 0) {
+    return;
+  }
+  #endif
+
+  if (major2 == (u8g2_uint_t)-1) {
+    major2--;
+  }
+
+  int16_t majorMin = swapxy ? u8g2->user_y0 : u8g2->user_x0;
+  int16_t majorMax = (swapxy ? u8g2->user_y1 : u8g2->user_x1) - 1;
+  int16_t minorMin = swapxy ? u8g2->user_x0 : u8g2->user_y0;
+  int16_t minorMax = (swapxy ? u8g2->user_x1 : u8g2->user_y1) - 1;
+  int8_t step = minor2 > minor1 ? 1 : -1;
+  int16_t err = dx >> 1;
+
+  // Steps along the major axis, clipped to the window on both axes. The
+  // minor coordinate after k steps is minor1 + step * n with
+  // n = ceil((k * dy - err) / dx).
+  int16_t first = (majorMin > major1 ? majorMin : major1) - major1;
+  int16_t last = (majorMax < major2 ? majorMax : major2) - major1;
+
+  if (dy == 0) {
+    if (minor1 < minorMin || minor1 > minorMax) {
+      return;
+    }
+  } else {
+    int16_t enter = step > 0 ? minorMin - minor1 : minor1 - minorMax;
+    int16_t leave = step > 0 ? minorMax - minor1 : minor1 - minorMin;
+
+    if (enter > 0) {
+      int16_t k = ((int32_t)(enter - 1) * dx + err) / dy + 1;
+      first = k > first ? k : first;
+    }
+    if (leave < 0) {
+      last = -1;
+    } else {
+      int32_t k = ((int32_t)leave * dx + err) / dy;
+      last = k < last ? k : last;
+    }
+  }
+
+  if (first > last) {
+    return;
+  }
+
+  int16_t n = (int32_t)first * dy > err ? ((int32_t)first * dy - err + dx - 1) / dx : 0;
+  err = err - (int32_t)first * dy + (int32_t)n * dx;
+
+  int16_t major = major1 + first;
+  int16_t minor = minor1 + step * n;
+  uint8_t color = u8g2->draw_color;
+  uint16_t stride = u8g2_GetU8x8(u8g2)->display_info->tile_width * 8;
+  uint8_t *buffer = u8g2->tile_buf_ptr;
+  int16_t count = last - first + 1;
+
+  if (!swapxy) {
+    // One pixel per column, the bit moves up or down a row on minor steps
+    int16_t row = minor - u8g2->pixel_curr_row;
+    uint8_t *target = buffer + (row >> 3) * stride + major;
+    uint8_t bit = 1 << (row & 7);
+
+    while (count-- > 0) {
+      write(target, bit, color);
+      target++;
+      err -= dy;
+      if (err < 0) {
+        err += dx;
+        if (step > 0) {
+          bit <<= 1;
+          if (bit == 0) {
+            bit = 0x01;
+            target += stride;
+          }
+        } else {
+          bit >>= 1;
+          if (bit == 0) {
+            bit = 0x80;
+            target -= stride;
+          }
+        }
+      }
+    }
+  } else {
+    // Vertical runs, the pixels of a column within one page are collected
+    // and written together
+    int16_t row = major - u8g2->pixel_curr_row;
+    uint8_t *target = buffer + (row >> 3) * stride + minor;
+    uint8_t bit = 1 << (row & 7);
+    uint8_t bits = 0;
+
+    while (count-- > 0) {
+      bits |= bit;
+      bit <<= 1;
+      err -= dy;
+      if (err < 0) {
+        err += dx;
+        write(target, bits, color);
+        bits = 0;
+        target += step;
+      }
+      if (bit == 0) {
+        if (bits != 0) {
+          write(target, bits, color);
+          bits = 0;
+        }
+        bit = 0x01;
+        target += stride;
+      }
+    }
+    if (bits != 0) {
+      write(target, bits, color);
+    }
+  }
+}
+
+uint32_t LineRasterizer::getLines(void)
+{
+  return _lines;
+}
+
+uint32_t LineRasterizer::getFallbacks(void)
+{
+  return _fallbacks;
+}
+
+uint32_t LineRasterizer::getLinesPerSecond(void)
+{
+  return _micros > 0 ? (uint64_t)_lines * 1000000 / _micros : 0;
+}
@@ -0,0 +1,36 @@
+#ifndef LineRasterizer_h
+#define LineRasterizer_h
+
+#include <Arduino.h>
+#include <U8g2lib.h>
+
+// Draws the pixels of u8g2_DrawLine() straight into a vertical_top_lsb
+// frame buffer. The line is clipped against the user window once, then
+// stepped from the first visible pixel to the last one. Pixels of a line
+// that fall into the same buffer byte are written with one operation.
+class LineRasterizer
+{
+
+public:
+  LineRasterizer(void);
+
+  // Same pixels as u8g2_DrawLine() in the current draw color. Other buffer
+  // layouts and rotations are drawn by u8g2.
+  void drawLine(u8g2_t *u8g2, u8g2_uint_t x1, u8g2_uint_t y1, u8g2_uint_t x2, u8g2_uint_t y2);
+
+  uint32_t getLines(void);
+  uint32_t getFallbacks(void);
+  // Only measured in builds with DISPLAYSTATS
+  uint32_t getLinesPerSecond(void);
+
+protected:
+  uint32_t _lines;
+  uint32_t _fallbacks;
+  uint32_t _micros;
+
+  void rasterize(u8g2_t *u8g2, int16_t major1, int16_t minor1, int16_t major2, int16_t minor2, int16_t dx, int16_t dy, bool swapxy);
+  void write(uint8_t *target, uint8_t bits, uint8_t color);
+
+};
+
+#endif
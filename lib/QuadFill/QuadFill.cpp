@@ -0,0 +1,234 @@
+#include "QuadFill.h"
+
+QuadFill::QuadFill(void)
+{
+  _quads = 0;
+  _fallbacks = 0;
+  _hits = 0;
+  _next = 0;
+  memset(_toggles, 0, sizeof(_toggles));
+
+  // Empty entries have no rows and match no quad
+  for (uint8_t i = 0; i < QUAD_FILL_CACHE_ENTRIES; i++) {
+    _entries[i].top = 1;
+    _entries[i].bottom = 0;
+  }
+}
+
+void QuadFill::fill(u8g2_t *u8g2, const uint8_t *x, const uint8_t *y)
+{
+  uint8_t top = y[0];
+  uint8_t bottom = y[0];
+  for (uint8_t i = 1; i < 4; i++) {
+    top = y[i] < top ? y[i] : top;
+    bottom = y[i] > bottom ? y[i] : bottom;
+  }
+
+  if (bottom - top >= QUAD_FILL_MAX_ROWS) {
+    _fallbacks++;
+    for (uint8_t i = 0; i < 4; i++) {
+      uint8_t j = (i + 1) & 3;
+      u8g2_DrawLine(u8g2, x[i], y[i], x[j], y[j]);
+    }
+    return;
+  }
+
+  _quads++;
+
+  #ifdef U8G2_WITH_CLIP_WINDOW_SUPPORT
+  if (u8g2->is_page_clip_window_intersection == 0) {
+    return;
+  }
+  #endif
+
+  // Quads on other pages are skipped before their edges are stepped
+  int16_t first = top > u8g2->user_y0 ? top : u8g2->user_y0;
+  int16_t last = bottom < u8g2->user_y1 - 1 ? bottom : u8g2->user_y1 - 1;
+  if (first > last) {
+    return;
+  }
+
+  const Entry *entry = lookup(x, y, top, bottom);
+
+  if (u8g2->cb != &u8g2_cb_r0 || u8g2->ll_hvline != u8g2_ll_hvline_vertical_top_lsb || u8g2->pixel_buf_width > QUAD_FILL_MAX_COLUMNS) {
+    for (int16_t row = first; row <= last; row++) {
+      uint8_t left = entry->left[row - top];
+      uint8_t right = entry->right[row - top];
+      if (left <= right) {
+        u8g2_DrawHLine(u8g2, left, row, right - left + 1);
+      }
+    }
+    return;
+  }
+
+  for (int16_t row = first; row <= last; row = (row | 7) + 1) {
+    fillPage(u8g2, entry, row, (row | 7) < last ? (row | 7) : last);
+  }
+}
+
+// The rows of the quad, from the cache or stepped from its edges into the
+// oldest entry
+QuadFill::Entry *QuadFill::lookup(const uint8_t *x, const uint8_t *y, uint8_t top, uint8_t bottom)
+{
+  for (uint8_t i = 0; i < QUAD_FILL_CACHE_ENTRIES; i++) {
+    Entry *entry = &_entries[i];
+    if (entry->top <= entry->bottom && memcmp(entry->x, x, 4) == 0 && memcmp(entry->y, y, 4) == 0) {
+      _hits++;
+      return entry;
+    }
+  }
+
+  Entry *entry = &_entries[_next];
+  _next = (_next + 1) % QUAD_FILL_CACHE_ENTRIES;
+
+  memcpy(entry->x, x, 4);
+  memcpy(entry->y, y, 4);
+  entry->top = top;
+  entry->bottom = bottom;
+  memset(entry->left, 0xFF, bottom - top + 1);
+  memset(entry->right, 0, bottom - top + 1);
+  for (uint8_t i = 0; i < 4; i++) {
+    uint8_t j = (i + 1) & 3;
+    addEdge(entry, x[i], y[i] - top, x[j], y[j] - top);
+  }
+  return entry;
+}
+
+// The pixels of u8g2_DrawLine(), widening the rows they are in. Rows are
+// counted from the top of the quad.
+void QuadFill::addEdge(Entry *entry, int16_t x1, int16_t y1, int16_t x2, int16_t y2)
+{
+  uint8_t *left = entry->left;
+  uint8_t *right = entry->right;
+  int16_t dx = x1 > x2 ? x1 - x2 : x2 - x1;
+  int16_t dy = y1 > y2 ? y1 - y2 : y2 - y1;
+  bool swapxy = dy > dx;
+  int16_t tmp;
+
+  if (swapxy) {
+    tmp = dx; dx = dy; dy = tmp;
+    tmp = x1; x1 = y1; y1 = tmp;
+    tmp = x2; x2 = y2; y2 = tmp;
+  }
+  if (x1 > x2) {
+    tmp = x1; x1 = x2; x2 = tmp;
+    tmp = y1; y1 = y2; y2 = tmp;
+  }
+
+  int8_t step = y2 > y1 ? 1 : -1;
+  int16_t y = y1;
+
+  if (swapxy) {
+    // One pixel per row
+    int16_t err = dx >> 1;
+    for (int16_t x = x1; x <= x2; x++) {
+      left[x] = y < left[x] ? y : left[x];
+      right[x] = y > right[x] ? y : right[x];
+      err -= dy;
+      int16_t carry = err >> 15;
+      y += step & carry;
+      err += dx & carry;
+    }
+    return;
+  }
+
+  // A run of pixels per row, only its ends matter. The runs are q or q + 1
+  // pixels long, the error of u8g2_DrawLine() after every run is remainder
+  // of a division by dy.
+  int16_t start = x1;
+  if (dy > 0) {
+    uint8_t q = dx / dy;
+    uint8_t r = dx % dy;
+    uint8_t run = (q >> 1) + 1;
+    uint8_t rest = ((q & 1) * dy + r) >> 1;
+    for (int16_t row = 0; row < dy; row++) {
+      left[y] = start < left[y] ? start : left[y];
+      start += run;
+      right[y] = start - 1 > right[y] ? start - 1 : right[y];
+      y += step;
+      rest += r;
+      run = q + (rest >= dy);
+      rest -= rest >= dy ? dy : 0;
+    }
+  }
+  left[y] = start < left[y] ? start : left[y];
+  right[y] = x2 > right[y] ? x2 : right[y];
+}
+
+// Rows first..last lie in one page
+void QuadFill::fillPage(u8g2_t *u8g2, const Entry *entry, int16_t first, int16_t last)
+{
+  const uint8_t *left = entry->left + (first - entry->top);
+  const uint8_t *right = entry->right + (first - entry->top);
+  uint8_t rows = last - first + 1;
+  int16_t clipLeft = u8g2->user_x0;
+  int16_t clipRight = u8g2->user_x1 - 1;
+  int16_t from = clipRight + 1;
+  int16_t to = clipLeft - 1;
+
+  // A row toggles its bit at its first column and after its last one, the
+  // running XOR over the columns is the column mask. The toggles are
+  // cleared again while the masks are written.
+  uint8_t *toggles = _toggles;
+  uint8_t bit = 1 << (first & 7);
+  for (uint8_t row = 0; row < rows; row++, bit <<= 1) {
+    int16_t l = left[row];
+    int16_t r = right[row];
+    if (l < clipLeft || r > clipRight) {
+      l = l > clipLeft ? l : clipLeft;
+      r = r < clipRight ? r : clipRight;
+      if (l > r) {
+        continue;
+      }
+    }
+    toggles[l] ^= bit;
+    toggles[r + 1] ^= bit;
+    from = l < from ? l : from;
+    to = r > to ? r : to;
+  }
+  if (from > to) {
+    return;
+  }
+
+  uint16_t stride = u8g2_GetU8x8(u8g2)->display_info->tile_width * 8;
+  uint8_t *target = u8g2->tile_buf_ptr + ((first - u8g2->pixel_curr_row) >> 3) * stride;
+  uint8_t color = u8g2->draw_color;
+  uint8_t mask = 0;
+  uint8_t i;
+
+  toggles[to + 1] = 0;
+  if (color == 1) {
+    for (i = from; i <= to; i++) {
+      mask ^= toggles[i];
+      toggles[i] = 0;
+      target[i] |= mask;
+    }
+  } else if (color == 0) {
+    for (i = from; i <= to; i++) {
+      mask ^= toggles[i];
+      toggles[i] = 0;
+      target[i] &= ~mask;
+    }
+  } else {
+    for (i = from; i <= to; i++) {
+      mask ^= toggles[i];
+      toggles[i] = 0;
+      target[i] ^= mask;
+    }
+  }
+}
+
+uint32_t QuadFill::getQuads(void)
+{
+  return _quads;
+}
+
+uint32_t QuadFill::getFallbacks(void)
+{
+  return _fallbacks;
+}
+
+uint32_t QuadFill::getHits(void)
+{
+  return _hits;
+}
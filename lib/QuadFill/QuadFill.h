@@ -0,0 +1,61 @@
+#ifndef QuadFill_h
+#define QuadFill_h
+
+#include <Arduino.h>
+#include <U8g2lib.h>
+
+// Rows a quad can span, taller quads are drawn as outlines
+#define QUAD_FILL_MAX_ROWS 32
+
+// Buffer width for the column masks, wider buffers are filled by u8g2
+#define QUAD_FILL_MAX_COLUMNS 128
+
+// Quads whose rows are kept, the clock fills two hands per frame
+#define QUAD_FILL_CACHE_ENTRIES 2
+
+// Fills convex quads like the hand kites. The edges are stepped like
+// u8g2_DrawLine() to find the leftmost and rightmost pixel of every row,
+// so the filled quad covers the outline drawn with lines. The rows of the
+// last quads are kept, a hand that is filled again on the next page or in
+// the next frame skips the edges. In a vertical_top_lsb buffer the rows of
+// one page are collected into column masks and every buffer byte is
+// written once.
+class QuadFill
+{
+
+public:
+  QuadFill(void);
+
+  // Corners in drawing order, in the current draw color
+  void fill(u8g2_t *u8g2, const uint8_t *x, const uint8_t *y);
+
+  uint32_t getQuads(void);
+  uint32_t getFallbacks(void);
+  // Quads whose rows were taken from the cache
+  uint32_t getHits(void);
+
+protected:
+  struct Entry {
+    uint8_t x[4];
+    uint8_t y[4];
+    uint8_t top;
+    uint8_t bottom;
+    uint8_t left[QUAD_FILL_MAX_ROWS];
+    uint8_t right[QUAD_FILL_MAX_ROWS];
+  };
+
+  Entry _entries[QUAD_FILL_CACHE_ENTRIES];
+  uint8_t _next;
+  uint8_t _toggles[QUAD_FILL_MAX_COLUMNS + 1];
+
+  uint32_t _quads;
+  uint32_t _fallbacks;
+  uint32_t _hits;
+
+  Entry *lookup(const uint8_t *x, const uint8_t *y, uint8_t top, uint8_t bottom);
+  void addEdge(Entry *entry, int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+  void fillPage(u8g2_t *u8g2, const Entry *entry, int16_t first, int16_t last);
+
+};
+
+#endif
@@ -0,0 +1,63 @@
+#include "RenderScheduler.h"
+
+RenderScheduler::RenderScheduler(void)
+{
+  memset(&_last, 0, sizeof(_last));
+  _valid = false;
+  _lastFrameTime = 0;
+  _framesRendered = 0;
+  _framesSkipped = 0;
+}
+
+void RenderScheduler::invalidate(void)
+{
+  _valid = false;
+}
+
+uint8_t RenderScheduler::changedInputs(const RenderInputs &inputs)
+{
+  uint8_t changed = 0;
+
+  if (inputs.second != _last.second) changed |= RENDER_DEPENDS_SECOND;
+  if (inputs.minute != _last.minute) changed |= RENDER_DEPENDS_MINUTE;
+  if (inputs.hour != _last.hour) changed |= RENDER_DEPENDS_HOUR;
+  if (inputs.day != _last.day || inputs.month != _last.month ||
+      inputs.year != _last.year || inputs.dayOfWeek != _last.dayOfWeek) changed |= RENDER_DEPENDS_DATE;
+  if (inputs.wifiConnected != _last.wifiConnected) changed |= RENDER_DEPENDS_WIFI;
+  if (inputs.transferData != _last.transferData) changed |= RENDER_DEPENDS_TRANSFER;
+  if (inputs.otaState != _last.otaState) changed |= RENDER_DEPENDS_OTA;
+  if (inputs.rtcPresent != _last.rtcPresent) changed |= RENDER_DEPENDS_RTC;
+
+  return changed;
+}
+
+bool RenderScheduler::shouldRender(const RenderInputs &inputs, uint8_t dependencies, uint16_t minPeriod)
+{
+  uint32_t now = millis();
+
+  if (_valid && inputs.screen == _last.screen) {
+    uint8_t changed = changedInputs(inputs) & dependencies;
+    bool held = (changed & ~RENDER_DEPENDS_CLOCK) == 0 && now - _lastFrameTime < minPeriod;
+
+    if (changed == 0 || held) {
+      _framesSkipped++;
+      return false;
+    }
+  }
+
+  _last = inputs;
+  _valid = true;
+  _lastFrameTime = now;
+  _framesRendered++;
+  return true;
+}
+
+uint32_t RenderScheduler::getFramesRendered(void)
+{
+  return _framesRendered;
+}
+
+uint32_t RenderScheduler::getFramesSkipped(void)
+{
+  return _framesSkipped;
+}
@@ -0,0 +1,70 @@
+#ifndef RenderScheduler_h
+#define RenderScheduler_h
+
+#include <Arduino.h>
+
+// Inputs a screen can depend on
+#define RENDER_DEPENDS_SECOND   0x01
+#define RENDER_DEPENDS_MINUTE   0x02
+#define RENDER_DEPENDS_HOUR     0x04
+#define RENDER_DEPENDS_DATE     0x08
+#define RENDER_DEPENDS_WIFI     0x10
+#define RENDER_DEPENDS_TRANSFER 0x20
+#define RENDER_DEPENDS_OTA      0x40
+#define RENDER_DEPENDS_RTC      0x80
+
+#define RENDER_DEPENDS_TIME (RENDER_DEPENDS_SECOND | RENDER_DEPENDS_MINUTE | RENDER_DEPENDS_HOUR)
+#define RENDER_DEPENDS_ALL  0xFF
+
+// Inputs that change with the clock, the others are events like an HTTP
+// request that must be shown at once
+#define RENDER_DEPENDS_CLOCK (RENDER_DEPENDS_TIME | RENDER_DEPENDS_DATE)
+
+struct RenderInputs {
+  // Screen selection, a change always causes a redraw
+  uint8_t screen;
+
+  uint8_t second;
+  uint8_t minute;
+  uint8_t hour;
+  uint8_t day;
+  uint8_t month;
+  uint8_t year;
+  uint8_t dayOfWeek;
+  bool wifiConnected;
+  bool transferData;
+  uint8_t otaState;
+  bool rtcPresent;
+};
+
+// Decides whether a frame has to be drawn: only when one of the inputs
+// the current screen depends on has changed since the last drawn frame.
+class RenderScheduler
+{
+
+public:
+  RenderScheduler(void);
+
+  // The next shouldRender() returns true
+  void invalidate(void);
+
+  // A changed clock input is held back until minPeriod ms have passed since
+  // the last frame, other inputs and a screen change are drawn at once
+  bool shouldRender(const RenderInputs &inputs, uint8_t dependencies, uint16_t minPeriod = 0);
+
+  uint32_t getFramesRendered(void);
+  uint32_t getFramesSkipped(void);
+
+protected:
+  RenderInputs _last;
+  bool _valid;
+  uint32_t _lastFrameTime;
+
+  uint32_t _framesRendered;
+  uint32_t _framesSkipped;
+
+  uint8_t changedInputs(const RenderInputs &inputs);
+
+};
+
+#endif
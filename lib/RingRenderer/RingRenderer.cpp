@@ -0,0 +1,172 @@
+#include "RingRenderer.h"
+
+RingRenderer::RingRenderer(void)
+{
+  for (uint8_t i = 0; i < RING_RENDERER_SLOTS; i++) {
+    _slots[i].valid = false;
+  }
+  _next = 0;
+  _spans = 0;
+  _circlePixels = 0;
+}
+
+void RingRenderer::drawRing(u8g2_t *u8g2, u8g2_uint_t x0, u8g2_uint_t y0, u8g2_uint_t inner, u8g2_uint_t outer)
+{
+  if (u8g2->draw_color == 2) {
+    for (u8g2_uint_t r = inner; r <= outer && r >= inner; r++) {
+      u8g2_DrawCircle(u8g2, x0, y0, r, U8G2_DRAW_ALL);
+    }
+    return;
+  }
+  draw(u8g2, x0, y0, inner, outer, false);
+}
+
+void RingRenderer::drawAnnulus(u8g2_t *u8g2, u8g2_uint_t x0, u8g2_uint_t y0, u8g2_uint_t inner, u8g2_uint_t outer)
+{
+  draw(u8g2, x0, y0, inner, outer, true);
+}
+
+RingRenderer::Slot *RingRenderer::findSlot(uint8_t inner, uint8_t outer, bool filled)
+{
+  for (uint8_t i = 0; i < RING_RENDERER_SLOTS; i++) {
+    Slot *slot = &_slots[i];
+    if (slot->valid && slot->inner == inner && slot->outer == outer && slot->filled == filled) {
+      return slot;
+    }
+  }
+
+  Slot *slot = &_slots[_next];
+  _next = (_next + 1) % RING_RENDERER_SLOTS;
+  slot->valid = build(slot, inner, outer, filled);
+  return slot->valid ? slot : NULL;
+}
+
+// Marks the pixels of u8g2_draw_circle() for every radius in the lower
+// right quarter, one bit per column, and turns the rows into runs
+bool RingRenderer::build(Slot *slot, uint8_t inner, uint8_t outer, bool filled)
+{
+  uint32_t marks[RING_RENDERER_MAX_RADIUS + 1];
+
+  memset(marks, 0, sizeof(marks));
+  slot->inner = inner;
+  slot->outer = outer;
+  slot->filled = filled;
+  slot->pixels = 0;
+
+  for (uint8_t rad = inner; rad <= outer; rad++) {
+    u8g2_int_t f = 1 - rad;
+    u8g2_int_t ddF_x = 1;
+    u8g2_int_t ddF_y = -2 * rad;
+    u8g2_uint_t x = 0;
+    u8g2_uint_t y = rad;
+
+    for (;;) {
+      marks[y] |= (uint32_t)1 << x;
+      marks[x] |= (uint32_t)1 << y;
+      slot->pixels += 8;
+
+      if (x >= y) {
+        break;
+      }
+      if (f >= 0) {
+        y--;
+        ddF_y += 2;
+        f += ddF_y;
+      }
+      x++;
+      ddF_x += 2;
+      f += ddF_x;
+    }
+  }
+
+  for (uint8_t dy = 0; dy <= outer; dy++) {
+    uint32_t bits = marks[dy];
+    uint8_t count = 0;
+    uint8_t dx = 0;
+
+    while (bits != 0) {
+      while ((bits & 1) == 0) {
+        bits >>= 1;
+        dx++;
+      }
+      uint8_t from = dx;
+      while ((bits & 1) != 0 || (filled && bits != 0)) {
+        bits >>= 1;
+        dx++;
+      }
+
+      if (count == RING_RENDERER_MAX_RUNS) {
+        return false;
+      }
+      slot->runs[dy][count].from = from;
+      slot->runs[dy][count].to = dx - 1;
+      count++;
+    }
+    slot->runCount[dy] = count;
+  }
+
+  return true;
+}
+
+void RingRenderer::draw(u8g2_t *u8g2, u8g2_uint_t x0, u8g2_uint_t y0, uint8_t inner, uint8_t outer, bool filled)
+{
+  // Coordinates past the right or bottom end wrap around in u8g2
+  Slot *slot = NULL;
+  if (inner <= outer && outer <= RING_RENDERER_MAX_RADIUS && x0 + outer <= (u8g2_uint_t)-1 && y0 + outer <= (u8g2_uint_t)-1) {
+    slot = findSlot(inner, outer, filled);
+  }
+
+  if (slot == NULL) {
+    for (uint8_t r = inner; r <= outer && r >= inner; r++) {
+      u8g2_DrawCircle(u8g2, x0, y0, r, U8G2_DRAW_ALL);
+    }
+    return;
+  }
+
+  _circlePixels += slot->pixels;
+
+  for (uint8_t dy = 0; dy <= outer; dy++) {
+    for (uint8_t half = 0; half < 2; half++) {
+      int16_t y = half == 0 ? y0 - dy : y0 + dy;
+
+      // Rows outside the page are skipped, the center row is drawn once
+      if (y < u8g2->user_y0 || y >= u8g2->user_y1 || (half == 1 && dy == 0)) {
+        continue;
+      }
+
+      for (uint8_t i = 0; i < slot->runCount[dy]; i++) {
+        const Run &run = slot->runs[dy][i];
+
+        // The center column belongs to the left half only
+        drawSpan(u8g2, x0 - run.to, x0 - run.from, y);
+        drawSpan(u8g2, x0 + (run.from > 0 ? run.from : 1), x0 + run.to, y);
+      }
+    }
+  }
+}
+
+void RingRenderer::drawSpan(u8g2_t *u8g2, int16_t x0, int16_t x1, int16_t y)
+{
+  if (x0 < u8g2->user_x0) {
+    x0 = u8g2->user_x0;
+  }
+  if (x1 >= u8g2->user_x1) {
+    x1 = u8g2->user_x1 - 1;
+  }
+  if (x0 > x1) {
+    return;
+  }
+
+  u8g2_DrawHVLine(u8g2, x0, y, x1 - x0 + 1, 0);
+  _spans++;
+}
+
+uint32_t RingRenderer::getSpans(void)
+{
+  return _spans;
+}
+
+uint32_t RingRenderer::getCirclePixels(void)
+{
+  return _circlePixels;
+}
@@ -0,0 +1,68 @@
+#ifndef RingRenderer_h
+#define RingRenderer_h
+
+#include <Arduino.h>
+#include <U8g2lib.h>
+
+// Largest outer radius, larger rings are drawn by u8g2
+#define RING_RENDERER_MAX_RADIUS 31
+
+// Runs per row of a quarter ring
+#define RING_RENDERER_MAX_RUNS 3
+
+// Ring shapes kept, the older one is replaced
+#define RING_RENDERER_SLOTS 2
+
+// Draws concentric circles as horizontal spans. The pixels of a quarter
+// ring are collected per row once for a pair of radii, every draw then
+// fills the runs of the rows in the current page, mirrored to the four
+// quarters.
+class RingRenderer
+{
+
+public:
+  RingRenderer(void);
+
+  // Same pixels as u8g2_DrawCircle() for every radius from inner to outer.
+  // XOR is drawn by u8g2 because the circles overlap.
+  void drawRing(u8g2_t *u8g2, u8g2_uint_t x0, u8g2_uint_t y0, u8g2_uint_t inner, u8g2_uint_t outer);
+
+  // Fills the band between the circles with radius inner and outer
+  void drawAnnulus(u8g2_t *u8g2, u8g2_uint_t x0, u8g2_uint_t y0, u8g2_uint_t inner, u8g2_uint_t outer);
+
+  // Horizontal lines drawn and the u8g2_DrawPixel() calls of the same
+  // circles drawn by u8g2
+  uint32_t getSpans(void);
+  uint32_t getCirclePixels(void);
+
+protected:
+  struct Run {
+    uint8_t from;
+    uint8_t to;
+  };
+
+  struct Slot {
+    uint8_t inner;
+    uint8_t outer;
+    bool filled;
+    bool valid;
+    // Pixel calls of u8g2_draw_circle() for these radii
+    uint16_t pixels;
+    uint8_t runCount[RING_RENDERER_MAX_RADIUS + 1];
+    Run runs[RING_RENDERER_MAX_RADIUS + 1][RING_RENDERER_MAX_RUNS];
+  };
+
+  Slot _slots[RING_RENDERER_SLOTS];
+  uint8_t _next;
+
+  uint32_t _spans;
+  uint32_t _circlePixels;
+
+  Slot *findSlot(uint8_t inner, uint8_t outer, bool filled);
+  bool build(Slot *slot, uint8_t inner, uint8_t outer, bool filled);
+  void draw(u8g2_t *u8g2, u8g2_uint_t x0, u8g2_uint_t y0, uint8_t inner, uint8_t outer, bool filled);
+  void drawSpan(u8g2_t *u8g2, int16_t x0, int16_t x1, int16_t y);
+
+};
+
+#endif
@@ -0,0 +1,103 @@
+#include "RulerStrip.h"
+
+RulerStrip::RulerStrip(void)
+{
+  _period = 0;
+  _labelSpacing = 0;
+  _font = NULL;
+}
+
+void RulerStrip::invalidate(void)
+{
+  _font = NULL;
+}
+
+bool RulerStrip::isRendered(const uint8_t *font)
+{
+  return _font != NULL && _font == font;
+}
+
+uint16_t RulerStrip::readColumn(u8g2_t *u8g2, uint8_t x)
+{
+  uint8_t *ptr = u8g2_GetBufferPtr(u8g2) + x;
+  uint16_t width = u8g2->pixel_buf_width;
+
+  return ptr[0] | ((uint16_t)ptr[width] << 8);
+}
+
+void RulerStrip::capture(u8g2_t *u8g2, const uint8_t *font, uint8_t period, uint8_t labelSpacing)
+{
+  uint16_t bufferWidth = u8g2->pixel_buf_width;
+
+  if (period > RULER_STRIP_WIDTH) {
+    period = RULER_STRIP_WIDTH;
+  }
+
+  // The first two pages hold the strip, the buffer must have them
+  if (u8g2_GetBufferTileHeight(u8g2) < 2) {
+    return;
+  }
+
+  for (uint8_t x = 0; x < period; x++) {
+    _columns[x] = readColumn(u8g2, x);
+  }
+
+  for (uint16_t x = period; x < bufferWidth; x++) {
+    _columns[x % period] |= readColumn(u8g2, x);
+  }
+
+  _period = period;
+  _labelSpacing = labelSpacing;
+  _font = font;
+}
+
+void RulerStrip::draw(u8g2_t *u8g2, uint8_t offset, uint8_t y)
+{
+  if (_font == NULL || _period == 0) {
+    return;
+  }
+
+  // Top row of the strip relative to the buffer, the buffer may be one page only
+  int16_t top = (int16_t)y - (RULER_STRIP_HEIGHT - 1) - u8g2->pixel_curr_row;
+  int16_t bufferHeight = u8g2->pixel_buf_height;
+  uint16_t bufferWidth = u8g2->pixel_buf_width;
+
+  if (top >= bufferHeight || top + RULER_STRIP_HEIGHT <= 0) {
+    return;
+  }
+
+  // Strip rows land in up to three pages starting at firstPage
+  int8_t firstPage = top >= 0 ? top >> 3 : -((7 - top) >> 3);
+  uint8_t shift = top - firstPage * 8;
+  uint8_t pages = bufferHeight >> 3;
+  uint8_t *buffer = u8g2_GetBufferPtr(u8g2);
+  uint8_t position = offset % _period;
+
+  // The label whose tick is cut off at the left edge is dropped up to the
+  // middle between its tick and the next one
+  uint8_t cutLabel = 0;
+  if (_labelSpacing > 0) {
+    uint8_t sinceTick = position % _labelSpacing;
+    if (sinceTick > 0 && sinceTick < _labelSpacing / 2) {
+      cutLabel = _labelSpacing / 2 - sinceTick;
+    }
+  }
+  uint16_t tickRows = ((1 << RULER_STRIP_TICK_HEIGHT) - 1) << (RULER_STRIP_HEIGHT - RULER_STRIP_TICK_HEIGHT);
+
+  for (uint16_t x = 0; x < bufferWidth; x++) {
+    uint16_t column = x < cutLabel ? _columns[position] & tickRows : _columns[position];
+    uint32_t bits = (uint32_t)column << shift;
+
+    for (int8_t page = firstPage; page < firstPage + 3; page++) {
+      if (page >= 0 && page < pages) {
+        buffer[page * bufferWidth + x] |= (uint8_t)bits;
+      }
+      bits >>= 8;
+    }
+
+    position++;
+    if (position >= _period) {
+      position = 0;
+    }
+  }
+}
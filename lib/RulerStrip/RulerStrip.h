@@ -0,0 +1,48 @@
+#ifndef RulerStrip_h
+#define RulerStrip_h
+
+#include <Arduino.h>
+#include <U8g2lib.h>
+
+// One full turn of a ruler tape, in pixels
+#define RULER_STRIP_WIDTH 120
+
+// Rows above and including the baseline of the tape
+#define RULER_STRIP_HEIGHT 16
+
+// Rows of the ticks at the bottom of the strip, the labels are above them
+#define RULER_STRIP_TICK_HEIGHT 3
+
+// Pre-rendered ruler tape. One period of the tape is captured from the
+// frame buffer once, every frame copies a window of it at an offset.
+class RulerStrip
+{
+
+public:
+  RulerStrip(void);
+
+  void invalidate(void);
+  bool isRendered(const uint8_t *font);
+
+  // Captures columns 0..period-1 of the ruler drawn into the frame buffer
+  // with its baseline at RULER_STRIP_HEIGHT - 1. Columns drawn past the
+  // period wrap around to the start of the strip. Labels are centered on
+  // every labelSpacing-th column, starting with column 0.
+  void capture(u8g2_t *u8g2, const uint8_t *font, uint8_t period, uint8_t labelSpacing);
+
+  // ORs the strip, starting at offset, into the frame buffer with the
+  // baseline at y. Like the tape drawn directly, a label whose tick is left
+  // of the offset is not drawn.
+  void draw(u8g2_t *u8g2, uint8_t offset, uint8_t y);
+
+protected:
+  uint16_t _columns[RULER_STRIP_WIDTH];
+  uint8_t _period;
+  uint8_t _labelSpacing;
+  const uint8_t *_font;
+
+  uint16_t readColumn(u8g2_t *u8g2, uint8_t x);
+
+};
+
+#endif
@@ -0,0 +1,160 @@
+#include "ScreenMirror.h"
+
+ScreenMirror::ScreenMirror(void)
+{
+  _u8g2 = NULL;
+  _size = 0;
+  _seq = 0;
+  _chunkUsed = 0;
+  _length = 0;
+  _keyFrames = 0;
+  _deltaFrames = 0;
+  _rateStart = 0;
+  _rateBytes = 0;
+  _bytesPerSecond = 0;
+  memset(_sent, 0, sizeof(_sent));
+}
+
+void ScreenMirror::begin(u8g2_t *u8g2)
+{
+  _u8g2 = u8g2;
+  _size = 0;
+
+  // Only a full frame buffer holds the whole screen
+  if (u8g2_GetBufferTileHeight(u8g2) == u8g2_GetU8x8(u8g2)->display_info->tile_height) {
+    _size = u8g2_GetBufferTileWidth(u8g2) * u8g2_GetBufferTileHeight(u8g2) * 8;
+  }
+
+  if (_size > SCREEN_MIRROR_BUFFER_SIZE) {
+    _size = 0;
+  }
+
+  // A page left open across a reboot must not get a delta against the
+  // new empty copy
+  _seq = micros();
+}
+
+bool ScreenMirror::isKeyFrame(uint32_t seq)
+{
+  return seq == 0 || seq != _seq;
+}
+
+uint16_t ScreenMirror::measure(uint32_t seq)
+{
+  return encode(isKeyFrame(seq), NULL);
+}
+
+uint16_t ScreenMirror::write(uint32_t seq, Print &out)
+{
+  bool keyFrame = isKeyFrame(seq);
+  uint16_t length = encode(keyFrame, &out);
+  uint32_t now = millis();
+
+  if (_size > 0) {
+    memcpy(_sent, u8g2_GetBufferPtr(_u8g2), _size);
+  }
+  _seq++;
+
+  if (keyFrame) {
+    _keyFrames++;
+  } else {
+    _deltaFrames++;
+  }
+
+  _rateBytes += length;
+  if (now - _rateStart >= SCREEN_MIRROR_RATE_WINDOW) {
+    _bytesPerSecond = _rateBytes * 1000 / (now - _rateStart);
+    _rateStart = now;
+    _rateBytes = 0;
+  }
+
+  return length;
+}
+
+uint16_t ScreenMirror::encode(bool keyFrame, Print *out)
+{
+  const uint8_t *frame = u8g2_GetBufferPtr(_u8g2);
+  uint32_t next = _seq + 1;
+  uint16_t i = 0;
+
+  _chunkUsed = 0;
+  _length = 0;
+
+  put(keyFrame ? SCREEN_MIRROR_KEY_FRAME : SCREEN_MIRROR_DELTA_FRAME, out);
+  put(next, out);
+  put(next >> 8, out);
+  put(next >> 16, out);
+  put(next >> 24, out);
+  put(_size > 0 ? u8g2_GetBufferTileWidth(_u8g2) : 0, out);
+  put(_size > 0 ? u8g2_GetBufferTileHeight(_u8g2) : 0, out);
+
+  // A key frame is the XOR against an empty screen
+  while (i < _size) {
+    uint16_t start = i;
+
+    if ((frame[i] ^ (keyFrame ? 0 : _sent[i])) == 0) {
+      while (i < _size && i - start < 128 && (frame[i] ^ (keyFrame ? 0 : _sent[i])) == 0) {
+        i++;
+      }
+      put(i - start - 1, out);
+    } else {
+      while (i < _size && i - start < 128 && (frame[i] ^ (keyFrame ? 0 : _sent[i])) != 0) {
+        i++;
+      }
+      put(0x80 | (i - start - 1), out);
+      for (uint16_t j = start; j < i; j++) {
+        put(frame[j] ^ (keyFrame ? 0 : _sent[j]), out);
+      }
+    }
+  }
+
+  flush(out);
+  return _length;
+}
+
+void ScreenMirror::put(uint8_t value, Print *out)
+{
+  _length++;
+
+  if (out == NULL) {
+    return;
+  }
+
+  _chunk[_chunkUsed++] = value;
+  if (_chunkUsed == SCREEN_MIRROR_CHUNK_SIZE) {
+    flush(out);
+  }
+}
+
+void ScreenMirror::flush(Print *out)
+{
+  if (out != NULL && _chunkUsed > 0) {
+    out->write(_chunk, _chunkUsed);
+  }
+  _chunkUsed = 0;
+}
+
+uint32_t ScreenMirror::getSeq(void)
+{
+  return _seq;
+}
+
+uint32_t ScreenMirror::getKeyFrames(void)
+{
+  return _keyFrames;
+}
+
+uint32_t ScreenMirror::getDeltaFrames(void)
+{
+  return _deltaFrames;
+}
+
+uint32_t ScreenMirror::getBytesPerSecond(void)
+{
+  // Nothing was sent for a while
+  if (millis() - _rateStart >= 2 * SCREEN_MIRROR_RATE_WINDOW) {
+    return 0;
+  }
+
+  return _bytesPerSecond;
+}
@@ -0,0 +1,72 @@
+#ifndef ScreenMirror_h
+#define ScreenMirror_h
+
+#include <Arduino.h>
+#include <U8g2lib.h>
+
+// Size of the copy of the last sent frame, enough for a 128x64 full frame buffer
+#define SCREEN_MIRROR_BUFFER_SIZE 1024
+
+// Packet header: type, sequence number (4 bytes, little endian), width and
+// height in tiles
+#define SCREEN_MIRROR_HEADER_SIZE 7
+#define SCREEN_MIRROR_KEY_FRAME 'K'
+#define SCREEN_MIRROR_DELTA_FRAME 'D'
+
+// Bytes collected before they are written to the client
+#define SCREEN_MIRROR_CHUNK_SIZE 64
+
+// Bandwidth is averaged over this many ms
+#define SCREEN_MIRROR_RATE_WINDOW 1000
+
+// Mirrors the frame buffer to a web client. The first packet holds the whole
+// frame, the next ones only the XOR against the frame the client already
+// has, both run length encoded:
+//   0x00..0x7F  1..128 unchanged bytes
+//   0x80..0xFF  1..128 XOR bytes follow
+// The client sends back the sequence number of its frame, an unknown number
+// gets a key frame.
+class ScreenMirror
+{
+
+public:
+  ScreenMirror(void);
+
+  void begin(u8g2_t *u8g2);
+
+  // Packet length for a client holding frame seq, write() sends exactly this
+  // packet if the frame buffer is not changed in between
+  uint16_t measure(uint32_t seq);
+  uint16_t write(uint32_t seq, Print &out);
+
+  uint32_t getSeq(void);
+  uint32_t getKeyFrames(void);
+  uint32_t getDeltaFrames(void);
+
+  // Packet bytes sent per second, HTTP overhead not included
+  uint32_t getBytesPerSecond(void);
+
+protected:
+  u8g2_t *_u8g2;
+  uint16_t _size;
+  uint8_t _sent[SCREEN_MIRROR_BUFFER_SIZE];
+  uint32_t _seq;
+
+  uint8_t _chunk[SCREEN_MIRROR_CHUNK_SIZE];
+  uint8_t _chunkUsed;
+  uint16_t _length;
+
+  uint32_t _keyFrames;
+  uint32_t _deltaFrames;
+  uint32_t _rateStart;
+  uint32_t _rateBytes;
+  uint32_t _bytesPerSecond;
+
+  bool isKeyFrame(uint32_t seq);
+  uint16_t encode(bool keyFrame, Print *out);
+  void put(uint8_t value, Print *out);
+  void flush(Print *out);
+
+};
+
+#endif
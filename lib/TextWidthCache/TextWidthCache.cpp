@@ -0,0 +1,146 @@
+#include "TextWidthCache.h"
+
+TextWidthCache::TextWidthCache(void)
+{
+  _monospaceCount = 0;
+  _hits = 0;
+  _misses = 0;
+  _monospaceHits = 0;
+  clear();
+}
+
+void TextWidthCache::clear(void)
+{
+  for (uint8_t i = 0; i < TEXT_WIDTH_CACHE_SIZE; i++) {
+    _entries[i].font = NULL;
+  }
+  _nextEntry = 0;
+}
+
+void TextWidthCache::addMonospaceFont(const uint8_t *font)
+{
+  if (_monospaceCount >= TEXT_WIDTH_CACHE_MONOSPACE_FONTS || findMonospaceFont(font) != NULL) {
+    return;
+  }
+
+  // The advance and the glyphs are read on first use, when the font is set
+  _monospaceFonts[_monospaceCount].font = font;
+  _monospaceFonts[_monospaceCount].advance = -1;
+  _monospaceCount++;
+}
+
+TextWidthCache::MonospaceFont *TextWidthCache::findMonospaceFont(const uint8_t *font)
+{
+  for (uint8_t i = 0; i < _monospaceCount; i++) {
+    if (_monospaceFonts[i].font == font) {
+      return &_monospaceFonts[i];
+    }
+  }
+  return NULL;
+}
+
+// True when the font has a glyph for every character of the string
+bool TextWidthCache::hasGlyphs(u8g2_t *u8g2, MonospaceFont *font, const char *s, uint8_t length)
+{
+  if (font->advance < 0) {
+    font->advance = u8g2_GetGlyphWidth(u8g2, '0');
+    memset(font->glyphs, 0, sizeof(font->glyphs));
+    for (uint8_t c = TEXT_WIDTH_CACHE_MONOSPACE_FIRST; c <= TEXT_WIDTH_CACHE_MONOSPACE_LAST; c++) {
+      if (u8g2_IsGlyph(u8g2, c)) {
+        uint8_t bit = c - TEXT_WIDTH_CACHE_MONOSPACE_FIRST;
+        font->glyphs[bit >> 3] |= 1 << (bit & 7);
+      }
+    }
+  }
+
+  for (uint8_t i = 0; i < length; i++) {
+    uint8_t c = s[i];
+    if (c < TEXT_WIDTH_CACHE_MONOSPACE_FIRST || c > TEXT_WIDTH_CACHE_MONOSPACE_LAST) {
+      return false;
+    }
+    uint8_t bit = c - TEXT_WIDTH_CACHE_MONOSPACE_FIRST;
+    if ((font->glyphs[bit >> 3] & (1 << (bit & 7))) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Like u8g2_string_width() for a string whose glyphs are all in the font:
+// the advance of all glyphs but the last one, plus the pixel width and x
+// offset of the last glyph
+u8g2_uint_t TextWidthCache::monospaceWidth(u8g2_t *u8g2, MonospaceFont *font, const char *s, uint8_t length)
+{
+  u8g2->font_decode.glyph_width = 0;
+  int8_t dx = u8g2_GetGlyphWidth(u8g2, (uint8_t)s[length - 1]);
+
+  u8g2_uint_t width = (length - 1) * font->advance + dx;
+  if (u8g2->font_decode.glyph_width != 0) {
+    width -= dx;
+    width += u8g2->font_decode.glyph_width;
+    width += u8g2->glyph_x_offset;
+  }
+  return width;
+}
+
+u8g2_uint_t TextWidthCache::getStrWidth(u8g2_t *u8g2, const char *s)
+{
+  const uint8_t *font = u8g2->font;
+
+  // FNV-1a, the string ends like in u8x8_ascii_next()
+  uint32_t hash = 2166136261UL;
+  uint8_t length = 0;
+  while (s[length] != '\0' && s[length] != '\n' && length < 255) {
+    hash ^= (uint8_t)s[length];
+    hash *= 16777619UL;
+    length++;
+  }
+
+  if (length == 0) {
+    return 0;
+  }
+
+  MonospaceFont *monospace = findMonospaceFont(font);
+  if (monospace != NULL && hasGlyphs(u8g2, monospace, s, length)) {
+    _monospaceHits++;
+    return monospaceWidth(u8g2, monospace, s, length);
+  }
+
+  for (uint8_t i = 0; i < TEXT_WIDTH_CACHE_SIZE; i++) {
+    Entry &entry = _entries[i];
+    if (entry.font == font && entry.hash == hash && entry.length == length) {
+      _hits++;
+      return entry.width;
+    }
+  }
+
+  _misses++;
+
+  Entry &entry = _entries[_nextEntry];
+  entry.font = font;
+  entry.hash = hash;
+  entry.length = length;
+  entry.width = u8g2_GetStrWidth(u8g2, s);
+
+  _nextEntry++;
+  if (_nextEntry >= TEXT_WIDTH_CACHE_SIZE) {
+    _nextEntry = 0;
+  }
+
+  return entry.width;
+}
+
+uint32_t TextWidthCache::getHits(void)
+{
+  return _hits;
+}
+
+uint32_t TextWidthCache::getMisses(void)
+{
+  return _misses;
+}
+
+uint32_t TextWidthCache::getMonospaceHits(void)
+{
+  return _monospaceHits;
+}
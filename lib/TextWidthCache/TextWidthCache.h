@@ -0,0 +1,68 @@
+#ifndef TextWidthCache_h
+#define TextWidthCache_h
+
+#include <Arduino.h>
+#include <U8g2lib.h>
+
+#define TEXT_WIDTH_CACHE_SIZE 16
+#define TEXT_WIDTH_CACHE_MONOSPACE_FONTS 4
+
+// Codes a monospaced font is measured for, other strings are cached
+#define TEXT_WIDTH_CACHE_MONOSPACE_FIRST 32
+#define TEXT_WIDTH_CACHE_MONOSPACE_LAST 127
+
+// Remembers string widths measured by u8g2_GetStrWidth(). Entries are
+// keyed by the font pointer, a hash and the length of the string.
+// Fonts registered as monospaced are measured without walking the glyphs,
+// as long as the font has every glyph of the string. A missing glyph adds
+// nothing in u8g2, such strings go through the cache.
+class TextWidthCache
+{
+
+public:
+  TextWidthCache(void);
+
+  // All glyphs the font has must have the same advance
+  void addMonospaceFont(const uint8_t *font);
+
+  // Same result as u8g2_GetStrWidth() with the current font
+  u8g2_uint_t getStrWidth(u8g2_t *u8g2, const char *s);
+
+  void clear(void);
+
+  uint32_t getHits(void);
+  uint32_t getMisses(void);
+  uint32_t getMonospaceHits(void);
+
+protected:
+  struct Entry {
+    const uint8_t *font;
+    uint32_t hash;
+    uint8_t length;
+    u8g2_uint_t width;
+  };
+
+  struct MonospaceFont {
+    const uint8_t *font;
+    int8_t advance;
+    // One bit per code the font has a glyph for
+    uint8_t glyphs[(TEXT_WIDTH_CACHE_MONOSPACE_LAST - TEXT_WIDTH_CACHE_MONOSPACE_FIRST + 8) / 8];
+  };
+
+  Entry _entries[TEXT_WIDTH_CACHE_SIZE];
+  uint8_t _nextEntry;
+
+  MonospaceFont _monospaceFonts[TEXT_WIDTH_CACHE_MONOSPACE_FONTS];
+  uint8_t _monospaceCount;
+
+  uint32_t _hits;
+  uint32_t _misses;
+  uint32_t _monospaceHits;
+
+  MonospaceFont *findMonospaceFont(const uint8_t *font);
+  bool hasGlyphs(u8g2_t *u8g2, MonospaceFont *font, const char *s, uint8_t length);
+  u8g2_uint_t monospaceWidth(u8g2_t *u8g2, MonospaceFont *font, const char *s, uint8_t length);
+
+};
+
+#endif
@@ -0,0 +1,337 @@
+#include "TileTransport.h"
+
+// SSD1306 commands
+#define SSD1306_ADDRESSING_MODE 0x20
+#define SSD1306_HORIZONTAL_MODE 0x00
+#define SSD1306_COLUMN_WINDOW   0x21
+#define SSD1306_PAGE_WINDOW     0x22
+
+TileTransport::TileTransport(void)
+{
+  _u8g2 = NULL;
+  _frameSize = 0;
+  _valid = false;
+  _windowSupported = false;
+  _busy = false;
+  _windowed = false;
+  _tx = 0;
+  _ty = 0;
+  _windowX0 = 0;
+  _windowX1 = 0;
+  _windowY0 = 0;
+  _windowY1 = 0;
+  _lastBytesSent = 0;
+  _lastRuns = 0;
+  _lastPolls = 0;
+  _lastWorstPoll = 0;
+}
+
+void TileTransport::begin(u8g2_t *u8g2)
+{
+  _u8g2 = u8g2;
+  _frameSize = u8g2_GetBufferTileWidth(u8g2) * u8g2_GetBufferTileHeight(u8g2) * 8;
+  // The u8g2 init sequence leaves this controller in horizontal addressing mode
+  _windowSupported = u8g2_GetU8x8(u8g2)->display_cb == u8x8_d_ssd1306_128x64_noname;
+  invalidate();
+}
+
+void TileTransport::invalidate(void)
+{
+  _valid = false;
+}
+
+bool TileTransport::isPageMode(void)
+{
+  // Page buffer mode or a display bigger than the shadow copy
+  return _frameSize == 0 || _frameSize > TILE_TRANSPORT_BUFFER_SIZE ||
+      u8g2_GetBufferTileHeight(_u8g2) != u8g2_GetU8x8(_u8g2)->display_info->tile_height;
+}
+
+bool TileTransport::isTileDirty(uint8_t tx, uint8_t ty)
+{
+  uint16_t tile = (uint16_t)ty * u8g2_GetBufferTileWidth(_u8g2) + tx;
+  return (_dirty[tile >> 3] & (1 << (tile & 7))) != 0;
+}
+
+void TileTransport::markDirtyTiles(void)
+{
+  uint16_t tiles = _frameSize / 8;
+  uint8_t *buffer = u8g2_GetBufferPtr(_u8g2);
+
+  memset(_dirty, _valid ? 0x00 : 0xFF, sizeof(_dirty));
+  if (!_valid) {
+    return;
+  }
+
+  for (uint16_t tile = 0; tile < tiles; tile++) {
+    if (memcmp(buffer + tile * 8, _shadow + tile * 8, 8) != 0) {
+      _dirty[tile >> 3] |= 1 << (tile & 7);
+    }
+  }
+}
+
+// Last tile of the run starting at tx, clean gaps up to TILE_TRANSPORT_MAX_GAP included
+uint8_t TileTransport::findRunEnd(uint8_t tx, uint8_t ty, uint8_t maxTiles)
+{
+  uint8_t tileWidth = u8g2_GetBufferTileWidth(_u8g2);
+  uint8_t runEnd = tx;
+
+  for (uint8_t next = tx + 1; next < tileWidth && next - tx < maxTiles; next++) {
+    if (next - runEnd > TILE_TRANSPORT_MAX_GAP + 1) {
+      break;
+    }
+    if (isTileDirty(next, ty)) {
+      runEnd = next;
+    }
+  }
+
+  return runEnd;
+}
+
+void TileTransport::sendRun(uint8_t tx, uint8_t ty, uint8_t count)
+{
+  uint16_t offset = ((uint16_t)ty * u8g2_GetBufferTileWidth(_u8g2) + tx) * 8;
+  uint8_t *ptr = u8g2_GetBufferPtr(_u8g2) + offset;
+
+  u8x8_DrawTile(u8g2_GetU8x8(_u8g2), tx, ty, count, ptr);
+  memcpy(_shadow + offset, ptr, count * 8);
+
+  _lastBytesSent += count * 8;
+  _lastRuns++;
+}
+
+// Sends the next run of at most maxTiles tiles, returns the tiles sent
+uint8_t TileTransport::sendNextRun(uint8_t maxTiles)
+{
+  uint8_t tileWidth = u8g2_GetBufferTileWidth(_u8g2);
+  uint8_t tileHeight = u8g2_GetBufferTileHeight(_u8g2);
+
+  while (_ty < tileHeight) {
+    while (_tx < tileWidth && !isTileDirty(_tx, _ty)) {
+      _tx++;
+    }
+
+    if (_tx >= tileWidth) {
+      _tx = 0;
+      _ty++;
+      continue;
+    }
+
+    uint8_t runStart = _tx;
+    uint8_t runEnd = findRunEnd(runStart, _ty, maxTiles);
+
+    sendRun(runStart, _ty, runEnd - runStart + 1);
+    _tx = runEnd + 1;
+    return runEnd - runStart + 1;
+  }
+
+  return 0;
+}
+
+// Sends the next tile row of the window, returns the tiles sent
+uint8_t TileTransport::sendNextWindowRow(void)
+{
+  if (_ty > _windowY1) {
+    return 0;
+  }
+
+  u8x8_t *u8x8 = u8g2_GetU8x8(_u8g2);
+  uint8_t tileWidth = u8g2_GetBufferTileWidth(_u8g2);
+  uint8_t count = _windowX1 - _windowX0 + 1;
+  uint16_t offset = ((uint16_t)_ty * tileWidth + _windowX0) * 8;
+  uint8_t *ptr = u8g2_GetBufferPtr(_u8g2) + offset;
+  bool fullWindow = _windowX0 == 0 && _windowX1 == tileWidth - 1 &&
+      _windowY0 == 0 && _windowY1 == u8g2_GetBufferTileHeight(_u8g2) - 1;
+
+  u8x8_cad_StartTransfer(u8x8);
+
+  // The column and page pointers keep their position between transactions
+  if (_ty == _windowY0) {
+    u8x8_cad_SendCmd(u8x8, SSD1306_ADDRESSING_MODE);
+    u8x8_cad_SendArg(u8x8, SSD1306_HORIZONTAL_MODE);
+    u8x8_cad_SendCmd(u8x8, SSD1306_COLUMN_WINDOW);
+    u8x8_cad_SendArg(u8x8, _windowX0 * 8 + u8x8->x_offset);
+    u8x8_cad_SendArg(u8x8, _windowX1 * 8 + 7 + u8x8->x_offset);
+    u8x8_cad_SendCmd(u8x8, SSD1306_PAGE_WINDOW);
+    u8x8_cad_SendArg(u8x8, _windowY0);
+    u8x8_cad_SendArg(u8x8, _windowY1);
+    _lastRuns++;
+  }
+
+  u8x8_cad_SendData(u8x8, count * 8, ptr);
+  memcpy(_shadow + offset, ptr, count * 8);
+  _lastBytesSent += count * 8;
+
+  // u8x8_DrawTile() expects the full window again
+  if (_ty == _windowY1 && !fullWindow) {
+    u8x8_cad_SendCmd(u8x8, SSD1306_COLUMN_WINDOW);
+    u8x8_cad_SendArg(u8x8, u8x8->x_offset);
+    u8x8_cad_SendArg(u8x8, tileWidth * 8 - 1 + u8x8->x_offset);
+    u8x8_cad_SendCmd(u8x8, SSD1306_PAGE_WINDOW);
+    u8x8_cad_SendArg(u8x8, 0);
+    u8x8_cad_SendArg(u8x8, u8g2_GetBufferTileHeight(_u8g2) - 1);
+  }
+
+  u8x8_cad_EndTransfer(u8x8);
+
+  _ty++;
+  return count;
+}
+
+bool TileTransport::start(void)
+{
+  _lastBytesSent = 0;
+  _lastRuns = 0;
+  _lastPolls = 0;
+  _lastWorstPoll = 0;
+  _windowed = false;
+
+  if (isPageMode()) {
+    u8g2_SendBuffer(_u8g2);
+    _lastBytesSent = _frameSize;
+    _busy = false;
+    return false;
+  }
+
+  uint8_t tileWidth = u8g2_GetBufferTileWidth(_u8g2);
+  uint8_t tileHeight = u8g2_GetBufferTileHeight(_u8g2);
+
+  markDirtyTiles();
+  _valid = true;
+  _tx = 0;
+  _ty = 0;
+
+  if (_windowSupported) {
+    // Bounding box of the dirty tiles against the cost of sending them as runs
+    uint16_t runCost = 0;
+    _windowX0 = tileWidth;
+    _windowX1 = 0;
+    _windowY0 = tileHeight;
+    _windowY1 = 0;
+
+    for (uint8_t ty = 0; ty < tileHeight; ty++) {
+      for (uint8_t tx = 0; tx < tileWidth; tx++) {
+        if (!isTileDirty(tx, ty)) {
+          continue;
+        }
+
+        uint8_t runEnd = findRunEnd(tx, ty, 0xFF);
+        runCost += (runEnd - tx + 1) * 8 + TILE_TRANSPORT_RUN_COST;
+
+        if (tx < _windowX0) {
+          _windowX0 = tx;
+        }
+        if (runEnd > _windowX1) {
+          _windowX1 = runEnd;
+        }
+        if (ty < _windowY0) {
+          _windowY0 = ty;
+        }
+        _windowY1 = ty;
+        tx = runEnd;
+      }
+    }
+
+    if (_windowY0 < tileHeight) {
+      uint16_t windowCost = (_windowX1 - _windowX0 + 1) * (_windowY1 - _windowY0 + 1) * 8 + TILE_TRANSPORT_WINDOW_COST;
+      _windowed = windowCost <= runCost;
+      _ty = _windowed ? _windowY0 : 0;
+    }
+  }
+
+  _busy = true;
+  return true;
+}
+
+bool TileTransport::poll(uint8_t maxTiles, uint16_t maxMicros)
+{
+  if (!_busy) {
+    return false;
+  }
+
+  uint32_t startTime = micros();
+  uint8_t tiles = 0;
+
+  // A window row is never split, it counts as one run
+  while (tiles < maxTiles) {
+    uint8_t sent = _windowed ? sendNextWindowRow() : sendNextRun(maxTiles - tiles);
+
+    if (sent == 0) {
+      _busy = false;
+      break;
+    }
+
+    tiles += sent;
+    if (micros() - startTime >= maxMicros) {
+      break;
+    }
+  }
+
+  uint32_t elapsed = micros() - startTime;
+  if (elapsed > _lastWorstPoll) {
+    _lastWorstPoll = elapsed;
+  }
+  _lastPolls++;
+
+  return _busy;
+}
+
+void TileTransport::finish(void)
+{
+  while (_busy) {
+    uint8_t sent = _windowed ? sendNextWindowRow() : sendNextRun(0xFF);
+
+    if (sent == 0) {
+      _busy = false;
+    }
+  }
+}
+
+uint16_t TileTransport::send(void)
+{
+  if (start()) {
+    finish();
+  }
+
+  return _lastBytesSent;
+}
+
+bool TileTransport::isBusy(void)
+{
+  return _busy;
+}
+
+uint16_t TileTransport::getFrameSize(void)
+{
+  return _frameSize;
+}
+
+uint16_t TileTransport::getLastBytesSent(void)
+{
+  return _lastBytesSent;
+}
+
+uint16_t TileTransport::getLastBytesSaved(void)
+{
+  return _frameSize > _lastBytesSent ? _frameSize - _lastBytesSent : 0;
+}
+
+uint8_t TileTransport::getLastRuns(void)
+{
+  return _lastRuns;
+}
+
+bool TileTransport::getLastWindowed(void)
+{
+  return _windowed;
+}
+
+uint8_t TileTransport::getLastPolls(void)
+{
+  return _lastPolls;
+}
+
+uint32_t TileTransport::getLastWorstPoll(void)
+{
+  return _lastWorstPoll;
+}
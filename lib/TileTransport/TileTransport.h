@@ -0,0 +1,93 @@
+#ifndef TileTransport_h
+#define TileTransport_h
+
+#include <Arduino.h>
+#include <U8g2lib.h>
+
+// Size of the shadow copy, enough for a 128x64 full frame buffer
+#define TILE_TRANSPORT_BUFFER_SIZE 1024
+
+// Clean tiles between two dirty runs that are still sent as one run.
+// Starting a new run costs more on the bus than a few extra data bytes.
+#define TILE_TRANSPORT_MAX_GAP 1
+
+// Bus bytes spent besides tile data: a run sets column and page in its
+// own command transaction, a window sets addressing mode, column and page
+// range and restores the full window afterwards.
+#define TILE_TRANSPORT_RUN_COST 8
+#define TILE_TRANSPORT_WINDOW_COST 18
+
+// Sends only those 8x8 tiles of the u8g2 frame buffer that differ
+// from the last transmitted frame. A frame can be sent at once or in
+// slices by poll(); the frame buffer must not change until it is done.
+//
+// On an SSD1306 the dirty tiles can also go as one rectangle: the
+// controller's column/page window is set once and the rectangle is
+// streamed in a single data phase. start() picks whatever is cheaper
+// on the bus, a full frame is always sent this way.
+class TileTransport
+{
+
+public:
+  TileTransport(void);
+
+  void begin(u8g2_t *u8g2);
+
+  // Forget the display content, the next frame transmits everything
+  void invalidate(void);
+
+  // Sends the whole frame, returns the number of data bytes transmitted
+  uint16_t send(void);
+
+  // Starts a frame, returns true while there is something left to send
+  bool start(void);
+  // Sends runs until maxTiles tiles or maxMicros are used up, at least one
+  // run per call. Returns true while the frame is not complete.
+  bool poll(uint8_t maxTiles, uint16_t maxMicros);
+  // Sends the rest of the frame
+  void finish(void);
+  bool isBusy(void);
+
+  uint16_t getFrameSize(void);
+  uint16_t getLastBytesSent(void);
+  uint16_t getLastBytesSaved(void);
+  uint8_t getLastRuns(void);
+  bool getLastWindowed(void);
+  // Slices of the last frame and the longest of them
+  uint8_t getLastPolls(void);
+  uint32_t getLastWorstPoll(void);
+
+protected:
+  u8g2_t *_u8g2;
+  uint8_t _shadow[TILE_TRANSPORT_BUFFER_SIZE];
+  uint8_t _dirty[TILE_TRANSPORT_BUFFER_SIZE / 64];
+  uint16_t _frameSize;
+  bool _valid;
+  bool _windowSupported;
+
+  // Frame in flight: next tile, or next row of the window
+  bool _busy;
+  bool _windowed;
+  uint8_t _tx;
+  uint8_t _ty;
+  uint8_t _windowX0;
+  uint8_t _windowX1;
+  uint8_t _windowY0;
+  uint8_t _windowY1;
+
+  uint16_t _lastBytesSent;
+  uint8_t _lastRuns;
+  uint8_t _lastPolls;
+  uint32_t _lastWorstPoll;
+
+  bool isPageMode(void);
+  bool isTileDirty(uint8_t tx, uint8_t ty);
+  void markDirtyTiles(void);
+  uint8_t findRunEnd(uint8_t tx, uint8_t ty, uint8_t maxTiles);
+  uint8_t sendNextRun(uint8_t maxTiles);
+  uint8_t sendNextWindowRow(void);
+  void sendRun(uint8_t tx, uint8_t ty, uint8_t count);
+
+};
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef HandTable_h
+#define HandTable_h
+
+#include <Arduino.h>
+#include "Trigonometry.h"
+
+// Hand shapes, radii are given as offsets from the dial radius.
+// A hand is a kite: tip and tail on its axis, two side points
+// at +/- spread degrees.
+#define MINUTE_HAND_TIP 5
+#define MINUTE_HAND_TAIL 27
+#define MINUTE_HAND_SIDE 20
+#define MINUTE_HAND_SPREAD 8
+
+#define HOUR_HAND_TIP 10
+#define HOUR_HAND_TAIL 27
+#define HOUR_HAND_SIDE 22
+#define HOUR_HAND_SPREAD 12
+
+#define HAND_TABLE_MINUTE 0
+#define HAND_TABLE_HOUR 1
+
+// Vertices in drawing order: tip, side, tail, other side
+struct HandQuad {
+  uint8_t x[4];
+  uint8_t y[4];
+};
+
+template <int... I> struct HandIndexes {};
+template <int N, int... I> struct MakeHandIndexes : MakeHandIndexes<N - 1, N - 1, I...> {};
+template <int... I> struct MakeHandIndexes<0, I...> { typedef HandIndexes<I...> type; };
+
+// Hand vertices of one dial geometry, computed by the compiler
+template <uint8_t CenterX, uint8_t CenterY, uint8_t Radius>
+struct HandGeometry {
+  static constexpr HandQuad quad(int16_t angle, int16_t tip, int16_t tail, int16_t side, int16_t spread) {
+    return HandQuad{
+      {
+        (uint8_t)(CenterX + Trigonometry::polarXAt(Radius - tip, angle)),
+        (uint8_t)(CenterX + Trigonometry::polarXAt(Radius - side, angle + spread)),
+        (uint8_t)(CenterX + Trigonometry::polarXAt(Radius - tail, angle)),
+        (uint8_t)(CenterX + Trigonometry::polarXAt(Radius - side, angle - spread))
+      },
+      {
+        (uint8_t)(CenterY + Trigonometry::polarYAt(Radius - tip, angle)),
+        (uint8_t)(CenterY + Trigonometry::polarYAt(Radius - side, angle + spread)),
+        (uint8_t)(CenterY + Trigonometry::polarYAt(Radius - tail, angle)),
+        (uint8_t)(CenterY + Trigonometry::polarYAt(Radius - side, angle - spread))
+      }
+    };
+  }
+
+  static constexpr HandQuad minute(int m) {
+    return quad(m * 6 + 270, MINUTE_HAND_TIP, MINUTE_HAND_TAIL, MINUTE_HAND_SIDE, MINUTE_HAND_SPREAD);
+  }
+
+  // The hour hand moves one degree every two minutes, 360 positions in total
+  static constexpr HandQuad hour(int angle) {
+    return quad(angle + 270, HOUR_HAND_TIP, HOUR_HAND_TAIL, HOUR_HAND_SIDE, HOUR_HAND_SPREAD);
+  }
+
+  static constexpr HandQuad at(uint8_t kind, int index) {
+    return kind == HAND_TABLE_MINUTE ? minute(index) : hour(index);
+  }
+};
+
+template <uint8_t CenterX, uint8_t CenterY, uint8_t Radius, uint8_t Kind, class Indexes>
+struct HandTableData;
+
+template <uint8_t CenterX, uint8_t CenterY, uint8_t Radius, uint8_t Kind, int... I>
+struct HandTableData<CenterX, CenterY, Radius, Kind, HandIndexes<I...> > {
+  static const HandQuad values[sizeof...(I)];
+};
+
+template <uint8_t CenterX, uint8_t CenterY, uint8_t Radius, uint8_t Kind, int... I>
+const HandQuad HandTableData<CenterX, CenterY, Radius, Kind, HandIndexes<I...> >::values[sizeof...(I)] PROGMEM = {
+  HandGeometry<CenterX, CenterY, Radius>::at(Kind, I)...
+};
+
+// Hand vertices for all 60 minute and 720 hour+minute positions of a dial,
+// stored in flash. Drawing a hand is a table lookup and four lines.
+template <uint8_t CenterX, uint8_t CenterY, uint8_t Radius>
+class HandTable
+{
+
+public:
+  static bool matches(uint8_t centerX, uint8_t centerY, uint8_t radius) {
+    return centerX == CenterX && centerY == CenterY && radius == Radius;
+  }
+
+  static HandQuad minute(uint8_t m) {
+    HandQuad quad;
+    memcpy_P(&quad, &MinuteData::values[m % 60], sizeof(quad));
+    return quad;
+  }
+
+  static HandQuad hour(uint8_t h, uint8_t m) {
+    HandQuad quad;
+    memcpy_P(&quad, &HourData::values[(h % 12) * 30 + (m % 60) / 2], sizeof(quad));
+    return quad;
+  }
+
+protected:
+  typedef HandTableData<CenterX, CenterY, Radius, HAND_TABLE_MINUTE, typename MakeHandIndexes<60>::type> MinuteData;
+  typedef HandTableData<CenterX, CenterY, Radius, HAND_TABLE_HOUR, typename MakeHandIndexes<360>::type> HourData;
+
+};
+
+#endif
@@ -0,0 +1,89 @@
+#include "Trigonometry.h"
+
+#define TRIGONOMETRY_SINE_ROW(d) \
+  q15Sine(d), q15Sine(d + 1), q15Sine(d + 2), q15Sine(d + 3), q15Sine(d + 4), \
+  q15Sine(d + 5), q15Sine(d + 6), q15Sine(d + 7), q15Sine(d + 8), q15Sine(d + 9)
+
+static_assert(Trigonometry::q15Sine(0) == 0, "sin(0) must be 0");
+static_assert(Trigonometry::q15Sine(30) >= 16383 && Trigonometry::q15Sine(30) <= 16384, "sin(30) must be 0.5");
+static_assert(Trigonometry::q15Sine(90) == TRIGONOMETRY_Q15_ONE, "sin(90) must be 1");
+static_assert(Trigonometry::q15Sine(270) == -TRIGONOMETRY_Q15_ONE, "sin(270) must be -1");
+
+// Every element is a constant expression, so the table is built by the compiler
+const int16_t Trigonometry::sineTable[360] PROGMEM = {
+  TRIGONOMETRY_SINE_ROW(0),
+  TRIGONOMETRY_SINE_ROW(10),
+  TRIGONOMETRY_SINE_ROW(20),
+  TRIGONOMETRY_SINE_ROW(30),
+  TRIGONOMETRY_SINE_ROW(40),
+  TRIGONOMETRY_SINE_ROW(50),
+  TRIGONOMETRY_SINE_ROW(60),
+  TRIGONOMETRY_SINE_ROW(70),
+  TRIGONOMETRY_SINE_ROW(80),
+  TRIGONOMETRY_SINE_ROW(90),
+  TRIGONOMETRY_SINE_ROW(100),
+  TRIGONOMETRY_SINE_ROW(110),
+  TRIGONOMETRY_SINE_ROW(120),
+  TRIGONOMETRY_SINE_ROW(130),
+  TRIGONOMETRY_SINE_ROW(140),
+  TRIGONOMETRY_SINE_ROW(150),
+  TRIGONOMETRY_SINE_ROW(160),
+  TRIGONOMETRY_SINE_ROW(170),
+  TRIGONOMETRY_SINE_ROW(180),
+  TRIGONOMETRY_SINE_ROW(190),
+  TRIGONOMETRY_SINE_ROW(200),
+  TRIGONOMETRY_SINE_ROW(210),
+  TRIGONOMETRY_SINE_ROW(220),
+  TRIGONOMETRY_SINE_ROW(230),
+  TRIGONOMETRY_SINE_ROW(240),
+  TRIGONOMETRY_SINE_ROW(250),
+  TRIGONOMETRY_SINE_ROW(260),
+  TRIGONOMETRY_SINE_ROW(270),
+  TRIGONOMETRY_SINE_ROW(280),
+  TRIGONOMETRY_SINE_ROW(290),
+  TRIGONOMETRY_SINE_ROW(300),
+  TRIGONOMETRY_SINE_ROW(310),
+  TRIGONOMETRY_SINE_ROW(320),
+  TRIGONOMETRY_SINE_ROW(330),
+  TRIGONOMETRY_SINE_ROW(340),
+  TRIGONOMETRY_SINE_ROW(350)
+};
+
+int16_t Trigonometry::normalize(int16_t degree)
+{
+  degree %= 360;
+  if (degree < 0) {
+    degree += 360;
+  }
+  return degree;
+}
+
+int16_t Trigonometry::sin(int16_t degree)
+{
+  return (int16_t)pgm_read_word(&sineTable[normalize(degree)]);
+}
+
+int16_t Trigonometry::cos(int16_t degree)
+{
+  return sin(degree + 90);
+}
+
+int16_t Trigonometry::polarX(int16_t radius, int16_t degree)
+{
+  int32_t value = (int32_t)radius * cos(degree);
+  return (value + (1L << (TRIGONOMETRY_Q15_SHIFT - 1))) >> TRIGONOMETRY_Q15_SHIFT;
+}
+
+int16_t Trigonometry::polarY(int16_t radius, int16_t degree)
+{
+  int32_t value = (int32_t)radius * sin(degree);
+  return (value + (1L << (TRIGONOMETRY_Q15_SHIFT - 1))) >> TRIGONOMETRY_Q15_SHIFT;
+}
+
+Trigonometry::Point Trigonometry::polar(int16_t centerX, int16_t centerY, int16_t radius, int16_t degree)
+{
+  Point p;
+  p.x = centerX + polarX(radius, degree);
+  p.y = centerY + polarY(radius, degree);
+  return p;
+}
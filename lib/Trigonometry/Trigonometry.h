@@ -0,0 +1,82 @@
+#ifndef Trigonometry_h
+#define Trigonometry_h
+
+#include <Arduino.h>
+
+#ifdef __AVR__
+  #include <avr/pgmspace.h>
+#elif defined(ESP8266)
+  #include <pgmspace.h>
+#else
+  #define PROGMEM
+#endif
+
+// Integer trigonometry for the analog watch faces.
+// Angles are whole degrees, results are Q15 fixed point (32767 is 1.0).
+// The sine table is generated by the compiler, no float math at runtime.
+
+#define TRIGONOMETRY_Q15_ONE 32767
+#define TRIGONOMETRY_Q15_SHIFT 15
+
+class Trigonometry
+{
+
+public:
+  struct Point {
+    int16_t x;
+    int16_t y;
+  };
+
+  static int16_t sin(int16_t degree);
+  static int16_t cos(int16_t degree);
+
+  // radius * cos(degree) and radius * sin(degree), rounded to the nearest pixel
+  static int16_t polarX(int16_t radius, int16_t degree);
+  static int16_t polarY(int16_t radius, int16_t degree);
+  static Point polar(int16_t centerX, int16_t centerY, int16_t radius, int16_t degree);
+
+  static int16_t normalize(int16_t degree);
+
+  // Compile-time versions of polarX() and polarY(), same results
+  static constexpr int16_t polarXAt(int16_t radius, int16_t degree) {
+    return scale(radius, q15Sine(normalizeAt(degree + 90)));
+  }
+
+  static constexpr int16_t polarYAt(int16_t radius, int16_t degree) {
+    return scale(radius, q15Sine(normalizeAt(degree)));
+  }
+
+  // Compile-time sine, used to fill the table. Valid for 0..359 degrees.
+  static constexpr int16_t q15Sine(int16_t degree) {
+    return degree >= 180 ? -q15Sine(degree - 180)
+      : degree > 90 ? q15Sine(180 - degree)
+      : toQ15(taylor(toRadians(degree) * toRadians(degree), toRadians(degree), 1));
+  }
+
+protected:
+  static const int16_t sineTable[360];
+
+  static constexpr int16_t normalizeAt(int16_t degree) {
+    return ((degree % 360) + 360) % 360;
+  }
+
+  static constexpr int16_t scale(int16_t radius, int16_t value) {
+    return ((int32_t)radius * value + (1L << (TRIGONOMETRY_Q15_SHIFT - 1))) >> TRIGONOMETRY_Q15_SHIFT;
+  }
+
+  static constexpr double toRadians(int16_t degree) {
+    return degree * 3.14159265358979323846 / 180.0;
+  }
+
+  // x - x^3/3! + x^5/5! - ... up to x^19, enough for double precision on 0..pi/2
+  static constexpr double taylor(double x2, double term, int n) {
+    return n > 19 ? 0.0 : term + taylor(x2, -term * x2 / ((n + 1) * (n + 2)), n + 2);
+  }
+
+  static constexpr int16_t toQ15(double value) {
+    return value >= 0 ? (int16_t)(value * TRIGONOMETRY_Q15_ONE + 0.5) : (int16_t)(value * TRIGONOMETRY_Q15_ONE - 0.5);
+  }
+
+};
+
+#endif
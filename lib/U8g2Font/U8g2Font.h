@@ -0,0 +1,17 @@
+#ifndef U8g2Font_h
+#define U8g2Font_h
+
+#include <U8g2lib.h>
+
+// Functions of u8g2_font.c that are not static but missing from u8g2.h.
+// The glyph libraries use them to find and decode glyphs the way u8g2
+// does. The signatures are those of U8g2 2.25.7, check them here when
+// U8g2 is updated.
+extern "C" {
+  const uint8_t *u8g2_font_get_glyph_data(u8g2_t *u8g2, uint16_t encoding);
+  int8_t u8g2_font_decode_glyph(u8g2_t *u8g2, const uint8_t *glyph_data);
+  uint8_t u8g2_font_decode_get_unsigned_bits(u8g2_font_decode_t *f, uint8_t cnt);
+  int8_t u8g2_font_decode_get_signed_bits(u8g2_font_decode_t *f, uint8_t cnt);
+}
+
+#endif
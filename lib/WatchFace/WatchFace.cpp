@@ -0,0 +1,58 @@
+#include "WatchFace.h"
+
+WatchFaceRegistry::WatchFaceRegistry(void)
+{
+  _faces = NULL;
+  _count = 0;
+  _current = 0;
+}
+
+void WatchFaceRegistry::begin(const WatchFace *faces, uint8_t count)
+{
+  _faces = faces;
+  _count = count;
+  _current = _count > 0 ? 1 : 0;
+}
+
+bool WatchFaceRegistry::select(uint8_t id)
+{
+  if (id < 1 || id > _count) {
+    return false;
+  }
+
+  _current = id;
+  return true;
+}
+
+uint8_t WatchFaceRegistry::next(void)
+{
+  if (_count > 0) {
+    _current = _current >= _count ? 1 : _current + 1;
+  }
+
+  return _current;
+}
+
+const WatchFace *WatchFaceRegistry::getCurrent(void)
+{
+  return get(_current);
+}
+
+const WatchFace *WatchFaceRegistry::get(uint8_t id)
+{
+  if (id < 1 || id > _count) {
+    return NULL;
+  }
+
+  return &_faces[id - 1];
+}
+
+uint8_t WatchFaceRegistry::getCurrentId(void)
+{
+  return _current;
+}
+
+uint8_t WatchFaceRegistry::getCount(void)
+{
+  return _count;
+}
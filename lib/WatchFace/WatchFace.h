@@ -0,0 +1,47 @@
+#ifndef WatchFace_h
+#define WatchFace_h
+
+#include <Arduino.h>
+
+// A watch face is a row of callbacks, any of them except drawDynamic can be NULL
+struct WatchFace {
+  // Called before every frame, sets the layout and renders what needs the frame buffer
+  void (*prepare)(void);
+  // Drawn only when the cached background layer is missing
+  void (*drawStatic)(void);
+  // Drawn over the background on every frame
+  void (*drawDynamic)(void);
+
+  // RENDER_DEPENDS_* inputs the dynamic part shows
+  uint8_t dependencies;
+  // Shortest time between two frames in milliseconds
+  uint16_t minUpdatePeriod;
+};
+
+// Selects faces from a constant table, ids start at 1 so that 0 can mean "no face"
+class WatchFaceRegistry
+{
+
+public:
+  WatchFaceRegistry(void);
+
+  void begin(const WatchFace *faces, uint8_t count);
+
+  // Returns false and keeps the current face when the id is unknown
+  bool select(uint8_t id);
+  // Selects the following face, wraps around to the first one
+  uint8_t next(void);
+
+  const WatchFace *getCurrent(void);
+  const WatchFace *get(uint8_t id);
+  uint8_t getCurrentId(void);
+  uint8_t getCount(void);
+
+protected:
+  const WatchFace *_faces;
+  uint8_t _count;
+  uint8_t _current;
+
+};
+
+#endif
@@ -0,0 +1,373 @@
+# Builds subsets of the u8g2 fonts used by the firmware.
+#
+# The glyphs each font needs are listed in platformio.ini:
+#
+#   custom_font_subsets =
+#     u8g2_font_7x14B_tf " -~"
+#     u8g2_font_logisoso22_tn "0-9:"
+#
+# A range "a-b" includes both ends, "\-" and "\\" are a literal minus and
+# backslash. The subsets are written to include/SubsetFonts.h together with
+# defines that replace the original font names, and FONTSUBSET is defined
+# for the build. The full fonts are no longer referenced and left out by
+# the linker.
+#
+# Fonts listed in custom_font_raw also get a table of pre-decoded column
+# bitmaps for GlyphCache, <font>_raw, and FONTSUBSET_RAW is defined.
+#
+# Run by PlatformIO before the build (extra_scripts = pre:...). The build
+# stops when custom_font_subsets is set but the u8g2 font sources are not
+# found, the U8g2 copy in .piolibdeps must include src/clib/u8g2_fonts.c.
+# Each subset is checked against the full font, and the report gives the
+# glyph list steps u8g2 takes per glyph lookup before and after.
+#
+# "python scripts/subset_fonts.py path/to/u8g2_fonts.c" prints the report
+# for the subsets in platformio.ini without writing the header.
+
+import configparser
+import glob
+import os
+import re
+import sys
+
+# Font header, see u8g2_font.c
+FONT_HEADER_SIZE = 23
+
+# GLYPH_CACHE_BITMAP_SIZE, larger glyphs are left out of the raw tables
+RAW_BITMAP_SIZE = 48
+
+
+def parse_charset(spec):
+    chars = set()
+    items = []
+    i = 0
+    while i < len(spec):
+        if spec[i] == "\\" and i + 1 < len(spec):
+            items.append(spec[i + 1])
+            i += 2
+        else:
+            items.append(spec[i] if spec[i] != "-" else None)
+            i += 1
+
+    i = 0
+    while i < len(items):
+        if i + 2 < len(items) and items[i] is not None and items[i + 1] is None and items[i + 2] is not None:
+            for code in range(ord(items[i]), ord(items[i + 2]) + 1):
+                chars.add(code)
+            i += 3
+        else:
+            chars.add(ord(items[i]) if items[i] is not None else ord("-"))
+            i += 1
+    return chars
+
+
+def parse_subsets(option):
+    subsets = []
+    for line in option.splitlines():
+        line = line.strip()
+        if not line or line.startswith(";"):
+            continue
+        match = re.match(r'(\w+)\s+"(.*)"$', line)
+        if not match:
+            raise ValueError("custom_font_subsets: cannot read '%s'" % line)
+        subsets.append((match.group(1), parse_charset(match.group(2))))
+    return subsets
+
+
+def decode_c_string(text):
+    result = bytearray()
+    simple = {"n": 10, "t": 9, "r": 13, "a": 7, "b": 8, "f": 12, "v": 11,
+              "\\": 92, "'": 39, '"': 34, "?": 63}
+    i = 0
+    while i < len(text):
+        c = text[i]
+        if c != "\\":
+            result.append(ord(c))
+            i += 1
+            continue
+        i += 1
+        if text[i] in "01234567":
+            digits = re.match(r"[0-7]{1,3}", text[i:]).group(0)
+            result.append(int(digits, 8))
+            i += len(digits)
+        elif text[i] == "x":
+            digits = re.match(r"[0-9a-fA-F]+", text[i + 1:]).group(0)
+            result.append(int(digits, 16) & 0xFF)
+            i += 1 + len(digits)
+        else:
+            result.append(simple[text[i]])
+            i += 1
+    return bytes(result)
+
+
+def read_font(source, name):
+    match = re.search(r"\b" + name + r"\[\d+\][^=]*=\s*((?:\"(?:[^\"\\]|\\.)*\"\s*)+);", source)
+    if not match:
+        raise ValueError("font %s not found" % name)
+    literals = re.findall(r"\"((?:[^\"\\]|\\.)*)\"", match.group(1))
+    # Each literal ends its escapes: "\1" "2" is 1, 50 and not "\12"
+    return b"".join(decode_c_string(literal) for literal in literals)
+
+
+def read_word(font, offset):
+    return (font[offset] << 8) | font[offset + 1]
+
+
+def glyph_list(font):
+    # Glyphs up to code 255 as (encoding, record), the list ends with a
+    # record size of 0
+    glyphs = []
+    pos = FONT_HEADER_SIZE
+    while font[pos + 1] != 0:
+        glyphs.append((font[pos], font[pos:pos + font[pos + 1]]))
+        pos += font[pos + 1]
+    return glyphs, pos
+
+
+def lookup_steps(font, encoding):
+    # Glyph records u8g2_font_get_glyph_data() steps over to find encoding,
+    # starting at "A" or "a" when the font has those offsets
+    pos = FONT_HEADER_SIZE
+    if encoding >= ord("a"):
+        pos += read_word(font, 19)
+    elif encoding >= ord("A"):
+        pos += read_word(font, 17)
+    steps = 0
+    while font[pos + 1] != 0:
+        if font[pos] == encoding:
+            return steps
+        pos += font[pos + 1]
+        steps += 1
+    return None
+
+
+def average_steps(font, chars):
+    steps = [lookup_steps(font, code) for code in sorted(chars) if code < 256]
+    steps = [step for step in steps if step is not None]
+    return float(sum(steps)) / len(steps) if steps else 0.0
+
+
+def check_subset(font, subset, chars, name):
+    # Every kept glyph is found in the subset and has the same record
+    glyphs, _ = glyph_list(font)
+    records = dict(glyphs)
+    for code in chars:
+        if code not in records:
+            continue
+        if lookup_steps(subset, code) is None:
+            raise ValueError("%s: glyph %d missing in the subset" % (name, code))
+    for encoding, record in glyph_list(subset)[0]:
+        if records.get(encoding) != record:
+            raise ValueError("%s: glyph %d differs in the subset" % (name, encoding))
+
+
+def subset_font(font, chars):
+    glyphs, end = glyph_list(font)
+    unicode_start = FONT_HEADER_SIZE + read_word(font, 21)
+    kept = [(encoding, record) for encoding, record in glyphs if encoding in chars]
+
+    body = bytearray()
+    upper_a = None
+    lower_a = None
+    for encoding, record in kept:
+        if upper_a is None and encoding >= ord("A"):
+            upper_a = len(body)
+        if lower_a is None and encoding >= ord("a"):
+            lower_a = len(body)
+        body += record
+    if upper_a is None:
+        upper_a = len(body)
+    if lower_a is None:
+        lower_a = len(body)
+
+    # End of the list and the unicode part are kept as they are
+    body += font[end:unicode_start]
+    unicode_pos = len(body)
+    body += font[unicode_start:]
+
+    header = bytearray(font[:FONT_HEADER_SIZE])
+    header[0] = max(0, font[0] - (len(glyphs) - len(kept)))
+    header[17:19] = bytes([upper_a >> 8, upper_a & 0xFF])
+    header[19:21] = bytes([lower_a >> 8, lower_a & 0xFF])
+    header[21:23] = bytes([unicode_pos >> 8, unicode_pos & 0xFF])
+    return bytes(header + body), len(kept), len(glyphs)
+
+
+class BitReader:
+    # u8g2_font_decode_get_unsigned_bits(): least significant bits first
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+        self.bit = 0
+
+    def unsigned(self, count):
+        value = 0
+        for i in range(count):
+            value |= ((self.data[self.pos] >> self.bit) & 1) << i
+            self.bit += 1
+            if self.bit == 8:
+                self.bit = 0
+                self.pos += 1
+        return value
+
+    def signed(self, count):
+        return self.unsigned(count) - (1 << (count - 1))
+
+
+def decode_glyph(font, record):
+    # Column bitmap like GlyphCache::decode() and the number of RLE runs
+    reader = BitReader(record[2:])
+    width = reader.unsigned(font[4])
+    height = reader.unsigned(font[5])
+    offset_x = reader.signed(font[6])
+    offset_y = reader.signed(font[7])
+    advance = reader.signed(font[8])
+
+    bitmap = bytearray(width * ((height + 7) // 8))
+    runs = 0
+    x = 0
+    y = 0
+    while width > 0 and y < height:
+        lengths = (reader.unsigned(font[2]), reader.unsigned(font[3]))
+        while True:
+            for foreground in (0, 1):
+                length = lengths[foreground]
+                runs += 1
+                while length > 0:
+                    count = min(width - x, length)
+                    if foreground and y < height:
+                        for i in range(count):
+                            bitmap[(y >> 3) * width + x + i] |= 1 << (y & 7)
+                    x += count
+                    length -= count
+                    if x == width:
+                        x = 0
+                        y += 1
+            if reader.unsigned(1) == 0:
+                break
+    return width, height, offset_x, offset_y, advance, bytes(bitmap), runs
+
+
+def raw_table(font):
+    # Glyph count, then encoding, width, height, offsets, advance, bitmap
+    glyphs, _ = glyph_list(font)
+    table = bytearray([0])
+    runs = 0
+    columns = 0
+    for encoding, record in glyphs:
+        width, height, offset_x, offset_y, advance, bitmap, glyph_runs = decode_glyph(font, record)
+        if len(bitmap) > RAW_BITMAP_SIZE:
+            continue
+        table += bytes([encoding, width, height, offset_x & 0xFF, offset_y & 0xFF, advance & 0xFF])
+        table += bitmap
+        table[0] += 1
+        runs += glyph_runs
+        columns += len(bitmap)
+    return bytes(table), runs, columns, table[0]
+
+
+def c_array(name, data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("  " + ", ".join("%d" % b for b in data[i:i + 16]))
+    return "static const uint8_t %s[%d] U8X8_PROGMEM = {\n%s\n};\n" % (name, len(data), ",\n".join(lines))
+
+
+def find_font_source(project_dir):
+    patterns = [
+        os.path.join(project_dir, ".piolibdeps", "*", "src", "clib", "u8g2_fonts.c"),
+        os.path.join(project_dir, ".pio", "libdeps", "*", "*", "src", "clib", "u8g2_fonts.c"),
+    ]
+    for pattern in patterns:
+        found = glob.glob(pattern)
+        if found:
+            return found[0]
+    return None
+
+
+def build(source, subsets, raw_fonts):
+    out = ["// Generated by scripts/subset_fonts.py, do not edit", "",
+           "#ifndef SubsetFonts_h", "#define SubsetFonts_h", "", "#include <U8g2lib.h>", ""]
+    report = []
+
+    for name, chars in subsets:
+        font = read_font(source, name)
+        subset, kept, total = subset_font(font, chars)
+        check_subset(font, subset, chars, name)
+        out.append(c_array("subset_" + name, subset))
+        out.append("#define %s subset_%s" % (name, name))
+        line = "%-36s %3d of %3d glyphs, %5d -> %5d bytes, %5d saved" % (name, kept, total, len(font), len(subset), len(font) - len(subset))
+        # The glyph list walk is the part of drawing a glyph a subset speeds up
+        line += ", %.1f -> %.1f glyph list steps per lookup" % (average_steps(font, chars), average_steps(subset, chars))
+
+        if name in raw_fonts:
+            table, runs, columns, count = raw_table(subset)
+            out.append(c_array("raw_" + name, table))
+            out.append("#define %s_raw raw_%s" % (name, name))
+            line += ", raw %d bytes for %d glyphs, %d RLE runs -> %d column bytes" % (len(table), count, runs, columns)
+
+        out.append("")
+        report.append(line)
+
+    out.append("#endif")
+    return "\n".join(out) + "\n", report
+
+
+def run(env):
+    project_dir = env.subst("$PROJECT_DIR")
+    subsets = parse_subsets(env.GetProjectOption("custom_font_subsets", ""))
+    raw_fonts = env.GetProjectOption("custom_font_raw", "").split()
+    source_path = find_font_source(project_dir)
+
+    if not subsets:
+        return
+    if source_path is None:
+        sys.stderr.write("Font subsets: u8g2_fonts.c not found in the U8g2 library. "
+                         "Install the full library or remove custom_font_subsets from platformio.ini.\n")
+        env.Exit(1)
+
+    with open(source_path) as f:
+        header, report = build(f.read(), subsets, raw_fonts)
+
+    target = os.path.join(project_dir, "include", "SubsetFonts.h")
+    if not os.path.exists(target) or open(target).read() != header:
+        with open(target, "w") as f:
+            f.write(header)
+
+    print("Font subsets:")
+    for line in report:
+        print("  " + line)
+
+    env.Append(CPPDEFINES=["FONTSUBSET"])
+    if raw_fonts:
+        env.Append(CPPDEFINES=["FONTSUBSET_RAW"])
+
+
+def main(argv):
+    if len(argv) != 2:
+        sys.stderr.write("usage: subset_fonts.py path/to/u8g2_fonts.c\n")
+        return 2
+
+    project_dir = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+    config = configparser.ConfigParser(inline_comment_prefixes=(";",))
+    config.read(os.path.join(project_dir, "platformio.ini"))
+    section = config["env:d1_mini"]
+    subsets = parse_subsets(section.get("custom_font_subsets", ""))
+    raw_fonts = section.get("custom_font_raw", "").split()
+
+    with open(argv[1]) as f:
+        header, report = build(f.read(), subsets, raw_fonts)
+    for line in report:
+        print(line)
+    return 0
+
+
+try:
+    Import("env")
+except NameError:
+    env = None
+
+if env is not None:
+    run(env)
+elif __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -3,6 +3,30 @@
 #include <TimeLib.h>
 #include <DS1307RTC.h>
 #include <Timer.h>
+#include <Trigonometry.h>
+#include <HandTable.h>
+#include <TileTransport.h>
+#include <BackgroundLayer.h>
+#include <RenderScheduler.h>
+#include <RulerStrip.h>
+#include <TextWidthCache.h>
+#include <GlyphIndex.h>
+#include <GlyphCache.h>
+#include <LineRasterizer.h>
+#include <RingRenderer.h>
+#include <BoxFill.h>
+#include <QuadFill.h>
+#include <DisplayList.h>
+#include <DigitFormat.h>
+#include <WatchFace.h>
+#include <DisplayBus.h>
+#include <I2CBus.h>
+#ifdef DISPLAYPROFILE
+  #include <FrameProfiler.h>
+#endif
+#ifdef SCREENMIRROR
+  #include <ScreenMirror.h>
+#endif
 #include <ESP8266WiFi.h>
 #include <ESP8266WebServer.h>
 #include <ESP8266mDNS.h>
@@ -19,6 +43,11 @@
 
 #include <U8g2lib.h>
 
+// Fonts reduced to the glyphs in use, generated by scripts/subset_fonts.py
+#ifdef FONTSUBSET
+  #include <SubsetFonts.h>
+#endif
+
 #ifdef U8X8_HAVE_HW_SPI
   #include <SPI.h>
 #endif
@@ -50,12 +79,93 @@
 // Run demonstration mode. Watch faces do change every 30 seconds.
 //#define DEMOMODE
 
+// Print display transfer statistics to Serial after every frame: set
+// DISPLAYSTATS in build_flags in platformio.ini, the libraries measure
+// their draw times only in that build.
+
+// Profile the display bus time of every frame. The report is printed to
+// Serial every 32 frames and served on /profile.
+//#define DISPLAYPROFILE
+
+// Frames drawn from loop() are sent in slices of at most this many tiles
+// or microseconds, so the web server is not blocked for a whole frame
+#define FRAME_SLICE_TILES 16
+#define FRAME_SLICE_MICROS 3000
+
+// Frame buffer size. By default the whole 1 KB frame is kept in RAM. Set to
+// 2 or 1 to render the frame page by page into 256 or 128 bytes instead;
+// the background cache, tile diffing and pre-rendered rulers need the whole
+// frame and are left out.
+//#define PAGEBUFFER 2
+
+// Draw the minute and hour hands filled instead of as outlines.
+//#define FILLEDHANDS
+
+// Serve a live copy of the display on /screen. Only the changes since the
+// last frame a browser got are sent. Needs the whole frame buffer.
+//#define SCREENMIRROR
+
+#if defined(SCREENMIRROR) && defined(PAGEBUFFER)
+  #error "SCREENMIRROR needs the full frame buffer, remove PAGEBUFFER"
+#endif
+
+// I2C clocks, the DS1307 is specified up to 100 kHz only
+#define DISPLAY_I2C_CLOCK 400000
+#define RTC_I2C_CLOCK 100000
+#define RTC_I2C_ADDRESS 0x68
+
+// DS1307RTC transfers: a read writes the register pointer and reads seven
+// time registers, a write sends the stopped time and then the seconds.
+// Both stop after the first transaction when the RTC does not answer.
+#define RTC_READ_POINTER_BYTES 1
+#define RTC_READ_TIME_BYTES 7
+#define RTC_WRITE_TIME_BYTES 8
+#define RTC_WRITE_SECONDS_BYTES 2
+
+
+// I2C bus shared by the OLED and the RTC
+I2CBus i2cBus;
+uint8_t rtcDevice;
+uint8_t displayDevice;
+
+#ifdef DISPLAYPROFILE
+FrameProfiler displayProfiler;
+I2CDeviceStats frameStartStats;
+#endif
+
+#ifdef SCREENMIRROR
+ScreenMirror screenMirror;
+#endif
 
 // OLED
+#if PAGEBUFFER == 1
+U8G2_SSD1306_128X64_NONAME_1_HW_I2C u8g2(U8G2_R0, /* reset=*/ U8X8_PIN_NONE);
+#elif PAGEBUFFER == 2
+U8G2_SSD1306_128X64_NONAME_2_HW_I2C u8g2(U8G2_R0, /* reset=*/ U8X8_PIN_NONE);
+#else
 U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2(U8G2_R0, /* reset=*/ U8X8_PIN_NONE);
+TileTransport displayTransport;
+BackgroundLayer backgroundLayer;
+RulerStrip secondsStrip;
+RulerStrip minutesStrip;
+RulerStrip hoursStrip;
+#endif
+TextWidthCache textWidthCache;
+GlyphIndex glyphIndex;
+GlyphCache glyphCache;
+LineRasterizer lineRasterizer;
+RingRenderer ringRenderer;
+BoxFill boxFill;
+#ifdef FILLEDHANDS
+QuadFill quadFill;
+#endif
+#ifdef PAGEBUFFER
+DisplayList displayList;
+#endif
 
 uint8_t displayWidth;
 uint8_t displayHeight;
+bool sliceFrames = false;
 
 // ICONS
 // All set:
@@ -85,6 +195,8 @@ uint16_t icons[13]  = {
 // Time
 tmElements_t localTime;
 bool timeCorrect;
+// Whether the last read reached the DS1307, tells the two time errors apart
+bool rtcPresent;
 int8_t timezone = DEFAULTTIMEZONE;
 
 const char *monthName[12] = {
@@ -102,12 +214,22 @@ bool transferData = false;
 bool rebooting = false;
 bool uploadingError = false;
 
-const uint8_t totalWatchFaces = 6;
-uint8_t currentWatchFace = 6;
+WatchFaceRegistry watchFaces;
+const uint8_t defaultWatchFace = 6;
+
+// Screens other than watch faces (1..watchFaces.getCount())
+#define SCREEN_TIME_ERROR 0
+#define SCREEN_FIRMWARE_UPDATE 100
+#define SCREEN_REBOOTING 101
+#define SCREEN_FIRMWARE_ERROR 102
 
 uint8_t clockCenterX = 31;
 uint8_t clockCenterY = 31;
 uint8_t clockRad = 23;
+
+// Hand tables for the dials of faces 2 and 3 on a 128x64 display
+typedef HandTable<64, 39, 23> CenterDialHands;
+typedef HandTable<104, 39, 23> RightDialHands;
 uint8_t uploadingErrorCode = 0;
 
 HTTPUploadStatus uploadStatus;
@@ -122,6 +244,7 @@ enum align {
 // Timers
 Timer updateCurrentTimeTimer;
 Timer displayCurrentTimeTimer;
+RenderScheduler renderScheduler;
 #ifdef DEMOMODE
 Timer changeWatchFaceTimer;
 #endif
@@ -200,8 +323,20 @@ bool getDayOfWeek(const char *str) {
 */
 
 
-void updateCurrentTime() {
+void readCurrentTime() {
+  i2cBus.beginTransaction(rtcDevice);
   timeCorrect = RTC.read(localTime);
+  rtcPresent = RTC.chipPresent();
+  if (rtcPresent) {
+    i2cBus.endTransaction(rtcDevice, RTC_READ_POINTER_BYTES + RTC_READ_TIME_BYTES, 2);
+  } else {
+    i2cBus.endTransaction(rtcDevice, RTC_READ_POINTER_BYTES, 1);
+  }
+}
+
+// The RTC is not read while a frame is on the bus
+void updateCurrentTime() {
+  i2cBus.runOutsideFrame(readCurrentTime);
 }
 
 
@@ -210,93 +345,476 @@ void updateCurrentTime() {
 */
 
 
-void drawMark(int h) {
-  if (((localTime.Second % 5) == 0) && (h * 5 == localTime.Second)) {
-      return;
+#ifdef DISPLAYPROFILE
+
+void profileFrameStart() {
+  frameStartStats = i2cBus.getStats(displayDevice);
+}
+
+void profileFrameEnd() {
+  const I2CDeviceStats &stats = i2cBus.getStats(displayDevice);
+  displayProfiler.record(stats.bytes - frameStartStats.bytes, stats.transactions - frameStartStats.transactions, stats.micros - frameStartStats.micros);
+
+  if (displayProfiler.getFrames() % FRAME_PROFILER_HISTORY == 0) {
+    Serial.print(displayProfiler.getReport());
   }
+}
 
-  float x1, y1, x2, y2;
-  
-  h = h * 30;
-  h = h + 270;
-  
-  x1 = (clockRad - 1) * cos(h * 0.0175);
-  y1 = (clockRad - 1) * sin(h * 0.0175);
-  x2 = (clockRad - 5) * cos(h * 0.0175);
-  y2 = (clockRad - 5) * sin(h * 0.0175);
-  
-  u8g2.drawLine(x1 + clockCenterX, y1 + clockCenterY, x2 + clockCenterX, y2 + clockCenterY);
+#endif
+
+void frameSent() {
+  #ifdef DISPLAYPROFILE
+  profileFrameEnd();
+  #endif
+
+  i2cBus.endFrame();
+
+  #ifdef DISPLAYSTATS
+  #ifndef PAGEBUFFER
+  Serial.printf("Frame: %u bytes sent, %u saved, %u runs%s\n", displayTransport.getLastBytesSent(), displayTransport.getLastBytesSaved(), displayTransport.getLastRuns(), displayTransport.getLastWindowed() ? " in a window" : "");
+  Serial.printf("Frame slices: %u, longest %u us\n", displayTransport.getLastPolls(), displayTransport.getLastWorstPoll());
+  #endif
+  Serial.printf("Frames: %u rendered, %u skipped\n", renderScheduler.getFramesRendered(), renderScheduler.getFramesSkipped());
+  Serial.printf("Text width: %u hits, %u misses, %u monospace\n", textWidthCache.getHits(), textWidthCache.getMisses(), textWidthCache.getMonospaceHits());
+  Serial.printf("Glyph index: %u lookups, %u fallbacks, %u builds\n", glyphIndex.getLookups(), glyphIndex.getFallbacks(), glyphIndex.getBuilds());
+  Serial.printf("Glyph cache: %u hits, %u misses, %u us per hit, %u us per miss\n", glyphCache.getHits(), glyphCache.getMisses(), glyphCache.getHitMicros(), glyphCache.getMissMicros());
+  Serial.printf("Glyph blitter: %u uncached glyphs, %u aligned pages, %u shifted pages\n", glyphCache.getUncached(), glyphCache.getBlitter()->getAlignedPages(), glyphCache.getBlitter()->getShiftedPages());
+  Serial.printf("Lines: %u drawn, %u by u8g2, %u lines per second\n", lineRasterizer.getLines(), lineRasterizer.getFallbacks(), lineRasterizer.getLinesPerSecond());
+  Serial.printf("Rings: %u spans instead of %u circle pixels\n", ringRenderer.getSpans(), ringRenderer.getCirclePixels());
+  Serial.printf("Boxes: %u filled, %u by u8g2, %u bytes per second\n", boxFill.getBoxes(), boxFill.getFallbacks(), boxFill.getBytesPerSecond());
+  #ifdef FILLEDHANDS
+  Serial.printf("Filled hands: %u quads, %u from the cache, %u as outlines\n", quadFill.getQuads(), quadFill.getHits(), quadFill.getFallbacks());
+  #endif
+  #ifdef PAGEBUFFER
+  Serial.printf("Display list: %u bytes, %u frames, %u unchanged, %u too long, %u commands replayed, %u culled\n", displayList.getLength(), displayList.getFrames(), displayList.getUnchanged(), displayList.getOverflows(), displayList.getReplayed(), displayList.getCulled());
+  #endif
+  for (uint8_t i = 0; i < i2cBus.getDeviceCount(); i++) {
+    const I2CDeviceStats &stats = i2cBus.getStats(i);
+    Serial.printf("I2C 0x%02X: %u transactions, %u bytes, %u us\n", i2cBus.getAddress(i), stats.transactions, stats.bytes, stats.micros);
+  }
+  #endif
 }
 
-void drawSec(int s) {
-  if ((s % 5) == 0) {
+#ifdef PAGEBUFFER
+
+// Every page is sent by nextPage(), a frame is never left in flight
+bool frameInFlight() {
+  return false;
+}
+
+void finishFrame() {
+}
+
+void pollFrame() {
+}
+
+#else
+
+bool frameInFlight() {
+  return displayTransport.isBusy();
+}
+
+// Sends the rest of the frame in flight at once
+void finishFrame() {
+  if (displayTransport.isBusy()) {
+    displayTransport.finish();
+    frameSent();
+  }
+}
+
+// Called from loop(), sends the next slice of the frame in flight
+void pollFrame() {
+  if (displayTransport.isBusy() && !displayTransport.poll(FRAME_SLICE_TILES, FRAME_SLICE_MICROS)) {
+    frameSent();
+  }
+}
+
+void sendFrame() {
+  i2cBus.beginFrame();
+
+  #ifdef DISPLAYPROFILE
+  profileFrameStart();
+  #endif
+
+  if (!displayTransport.start()) {
+    frameSent();
     return;
   }
 
-  float x1, y1, x2, y2;
+  if (!sliceFrames) {
+    finishFrame();
+  }
+}
 
-  s = s * 6;
-  s = s + 270;
-  
-  x1 = (clockRad - 1) * cos(s * 0.0175);
-  y1 = (clockRad - 1) * sin(s * 0.0175);
-  x2 = (clockRad - 5) * cos(s * 0.0175);
-  y2 = (clockRad - 5) * sin(s * 0.0175);
+#endif
 
-  u8g2.drawLine(x1 + clockCenterX, y1 + clockCenterY, x2 + clockCenterX, y2 + clockCenterY);
+// Drawing calls of the screens. While a display list is recorded they are
+// only added to it. State changes are applied at once as well, so text
+// can still be measured.
+void setDrawColor(uint8_t color) {
+  #ifdef PAGEBUFFER
+  if (displayList.isRecording()) {
+    displayList.addColor(color);
+  }
+  #endif
+  u8g2.setColorIndex(color);
 }
 
-void drawMin(int m) {
-  float x1, y1, x2, y2, x3, y3, x4, y4;
+void setFont(const uint8_t *font) {
+  #ifdef PAGEBUFFER
+  if (displayList.isRecording()) {
+    displayList.addFont(font);
+  }
+  #endif
+  u8g2.setFont(font);
+}
 
-  m = m * 6;
-  m = m + 270;
-  
-  x1 = (clockRad - 5) * cos(m * 0.0175);
-  y1 = (clockRad - 5) * sin(m * 0.0175);
-  x2 = (clockRad - 27) * cos(m * 0.0175);
-  y2 = (clockRad - 27) * sin(m * 0.0175);
-  x3 = (clockRad - 20) * cos((m + 8) * 0.0175);
-  y3 = (clockRad - 20) * sin((m + 8) * 0.0175);
-  x4 = (clockRad - 20) * cos((m - 8) * 0.0175);
-  y4 = (clockRad - 20) * sin((m - 8) * 0.0175);
-  
-  u8g2.drawLine(x1 + clockCenterX, y1 + clockCenterY, x3 + clockCenterX, y3 + clockCenterY);
-  u8g2.drawLine(x3 + clockCenterX, y3 + clockCenterY, x2 + clockCenterX, y2 + clockCenterY);
-  u8g2.drawLine(x2 + clockCenterX, y2 + clockCenterY, x4 + clockCenterX, y4 + clockCenterY);
-  u8g2.drawLine(x4 + clockCenterX, y4 + clockCenterY, x1 + clockCenterX, y1 + clockCenterY);
+void setFontMode(uint8_t mode) {
+  #ifdef PAGEBUFFER
+  if (displayList.isRecording()) {
+    displayList.addFontMode(mode);
+  }
+  #endif
+  u8g2.setFontMode(mode);
+}
+
+void setFontDirection(uint8_t direction) {
+  #ifdef PAGEBUFFER
+  if (displayList.isRecording()) {
+    displayList.addFontDirection(direction);
+  }
+  #endif
+  u8g2.setFontDirection(direction);
+}
+
+void drawLine(uint8_t x1, uint8_t y1, uint8_t x2, uint8_t y2) {
+  #ifdef PAGEBUFFER
+  if (displayList.isRecording()) {
+    displayList.addLine(x1, y1, x2, y2);
+    return;
+  }
+  #endif
+  lineRasterizer.drawLine(u8g2.getU8g2(), x1, y1, x2, y2);
+}
+
+void drawBox(uint8_t x, uint8_t y, uint8_t w, uint8_t h) {
+  #ifdef PAGEBUFFER
+  if (displayList.isRecording()) {
+    displayList.addBox(x, y, w, h);
+    return;
+  }
+  #endif
+  boxFill.drawBox(u8g2.getU8g2(), x, y, w, h);
+}
+
+void drawHLine(uint8_t x, uint8_t y, uint8_t w) {
+  #ifdef PAGEBUFFER
+  if (displayList.isRecording()) {
+    displayList.addHLine(x, y, w);
+    return;
+  }
+  #endif
+  boxFill.drawHLine(u8g2.getU8g2(), x, y, w);
+}
+
+void drawFrame(uint8_t x, uint8_t y, uint8_t w, uint8_t h) {
+  #ifdef PAGEBUFFER
+  if (displayList.isRecording()) {
+    displayList.addFrame(x, y, w, h);
+    return;
+  }
+  #endif
+  boxFill.drawFrame(u8g2.getU8g2(), x, y, w, h);
+}
+
+void drawRBox(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t r) {
+  #ifdef PAGEBUFFER
+  if (displayList.isRecording()) {
+    displayList.addRBox(x, y, w, h, r);
+    return;
+  }
+  #endif
+  u8g2.drawRBox(x, y, w, h, r);
+}
+
+void drawRFrame(uint8_t x, uint8_t y, uint8_t w, uint8_t h, uint8_t r) {
+  #ifdef PAGEBUFFER
+  if (displayList.isRecording()) {
+    displayList.addRFrame(x, y, w, h, r);
+    return;
+  }
+  #endif
+  u8g2.drawRFrame(x, y, w, h, r);
+}
+
+void drawRing(uint8_t x0, uint8_t y0, uint8_t inner, uint8_t outer) {
+  #ifdef PAGEBUFFER
+  if (displayList.isRecording()) {
+    displayList.addRing(x0, y0, inner, outer);
+    return;
+  }
+  #endif
+  ringRenderer.drawRing(u8g2.getU8g2(), x0, y0, inner, outer);
+}
+
+#ifdef FILLEDHANDS
+
+void fillQuad(const uint8_t *x, const uint8_t *y) {
+  #ifdef PAGEBUFFER
+  if (displayList.isRecording()) {
+    displayList.addQuad(x, y);
+    return;
+  }
+  #endif
+  quadFill.fill(u8g2.getU8g2(), x, y);
+}
+
+#endif
+
+void drawStr(uint8_t x, uint8_t y, const char *s) {
+  #ifdef PAGEBUFFER
+  if (displayList.isRecording()) {
+    displayList.addStr(x, y, s);
+    return;
+  }
+  #endif
+  glyphIndex.drawStr(u8g2.getU8g2(), x, y, s);
+}
+
+void drawGlyph(uint8_t x, uint8_t y, uint16_t encoding) {
+  #ifdef PAGEBUFFER
+  if (displayList.isRecording()) {
+    displayList.addGlyph(x, y, encoding);
+    return;
+  }
+  #endif
+  glyphIndex.drawGlyph(u8g2.getU8g2(), x, y, encoding);
+}
+
+#ifdef PAGEBUFFER
+
+// Replays a recorded call through the same functions
+void executeDisplayCommand(const DisplayCommand &c) {
+  const uint8_t *a = c.args;
+
+  switch (c.type) {
+    case DISPLAY_COLOR:
+      setDrawColor(a[0]);
+      break;
+
+    case DISPLAY_FONT:
+      setFont(c.font);
+      break;
+
+    case DISPLAY_FONT_MODE:
+      setFontMode(a[0]);
+      break;
+
+    case DISPLAY_FONT_DIRECTION:
+      setFontDirection(a[0]);
+      break;
+
+    case DISPLAY_LINE:
+      drawLine(a[0], a[1], a[2], a[3]);
+      break;
+
+    case DISPLAY_BOX:
+      drawBox(a[0], a[1], a[2], a[3]);
+      break;
+
+    case DISPLAY_HLINE:
+      drawHLine(a[0], a[1], a[2]);
+      break;
+
+    case DISPLAY_FRAME:
+      drawFrame(a[0], a[1], a[2], a[3]);
+      break;
+
+    case DISPLAY_RBOX:
+      drawRBox(a[0], a[1], a[2], a[3], a[4]);
+      break;
+
+    case DISPLAY_RFRAME:
+      drawRFrame(a[0], a[1], a[2], a[3], a[4]);
+      break;
+
+    case DISPLAY_RING:
+      drawRing(a[0], a[1], a[2], a[3]);
+      break;
+
+    #ifdef FILLEDHANDS
+    case DISPLAY_QUAD:
+      fillQuad(a, a + 4);
+      break;
+    #endif
+
+    case DISPLAY_STR:
+      drawStr(a[0], a[1], c.str);
+      break;
+
+    case DISPLAY_GLYPH:
+      drawGlyph(a[0], a[1], c.encoding);
+      break;
+
+    default:
+      break;
+  }
+}
+
+#endif
+
+// Draws a frame on a cleared buffer and sends it. With PAGEBUFFER draw()
+// runs once to record a display list that is replayed for every page. A
+// frame with the same list as the one on the display is not sent, one
+// that does not fit the list runs draw() for every page.
+template <class Draw>
+void renderFrame(Draw draw) {
+  #ifdef PAGEBUFFER
+  displayList.begin(u8g2.getU8g2());
+  draw();
+  displayList.end();
+
+  if (displayList.isUnchanged()) {
+    return;
+  }
+
+  i2cBus.beginFrame();
+
+  #ifdef DISPLAYPROFILE
+  profileFrameStart();
+  #endif
+
+  u8g2.firstPage();
+  do {
+    if (displayList.isComplete()) {
+      displayList.replay(u8g2.getU8g2(), executeDisplayCommand);
+    } else {
+      draw();
+    }
+  } while (u8g2.nextPage());
+
+  frameSent();
+  #else
+  u8g2.clearBuffer();
+  draw();
+  sendFrame();
+  #endif
+}
+
+// False when the rows top..bottom are not in the page being drawn. A
+// display list is recorded for all pages.
+bool pageIntersects(int16_t top, int16_t bottom) {
+  #ifdef PAGEBUFFER
+  if (displayList.isRecording()) {
+    return true;
+  }
+
+  u8g2_t *g = u8g2.getU8g2();
+  return bottom >= g->pixel_curr_row && top < g->pixel_curr_row + g->pixel_buf_height;
+  #else
+  (void)top;
+  (void)bottom;
+  return true;
+  #endif
+}
+
+bool dialOnPage() {
+  return pageIntersects(clockCenterY - clockRad, clockCenterY + clockRad);
+}
+
+void drawRadialLine(int16_t angle, int16_t r1, int16_t r2) {
+  Trigonometry::Point p1 = Trigonometry::polar(clockCenterX, clockCenterY, r1, angle);
+  Trigonometry::Point p2 = Trigonometry::polar(clockCenterX, clockCenterY, r2, angle);
+
+  drawLine(p1.x, p1.y, p2.x, p2.y);
+}
+
+void drawHandQuad(const HandQuad &q) {
+  #ifdef FILLEDHANDS
+  fillQuad(q.x, q.y);
+  #else
+  drawLine(q.x[0], q.y[0], q.x[1], q.y[1]);
+  drawLine(q.x[1], q.y[1], q.x[2], q.y[2]);
+  drawLine(q.x[2], q.y[2], q.x[3], q.y[3]);
+  drawLine(q.x[3], q.y[3], q.x[0], q.y[0]);
+  #endif
+}
+
+// Kite shaped hand: tip and tail on the hand axis, two side points at +/- spread degrees
+void drawHand(int16_t angle, int16_t tip, int16_t tail, int16_t side, int16_t spread) {
+  Trigonometry::Point p1 = Trigonometry::polar(clockCenterX, clockCenterY, tip, angle);
+  Trigonometry::Point p2 = Trigonometry::polar(clockCenterX, clockCenterY, tail, angle);
+  Trigonometry::Point p3 = Trigonometry::polar(clockCenterX, clockCenterY, side, angle + spread);
+  Trigonometry::Point p4 = Trigonometry::polar(clockCenterX, clockCenterY, side, angle - spread);
+  HandQuad q = {
+    { (uint8_t)p1.x, (uint8_t)p3.x, (uint8_t)p2.x, (uint8_t)p4.x },
+    { (uint8_t)p1.y, (uint8_t)p3.y, (uint8_t)p2.y, (uint8_t)p4.y }
+  };
+
+  drawHandQuad(q);
+}
+
+void drawMark(int h) {
+  drawRadialLine(h * 30 + 270, clockRad - 1, clockRad - 5);
+}
+
+void drawDialRim() {
+  drawRing(clockCenterX, clockCenterY, clockRad - 1, clockRad);
+}
+
+void drawSec(int s) {
+  if (!dialOnPage()) {
+    return;
+  }
+
+  if ((s % 5) == 0) {
+    // The second is shown by hiding the hour mark. The mark touches the rim,
+    // so the rim is drawn again after erasing.
+    setDrawColor(0);
+    drawMark(s / 5);
+    setDrawColor(1);
+    drawDialRim();
+    return;
+  }
+
+  drawRadialLine(s * 6 + 270, clockRad - 1, clockRad - 5);
+}
+
+void drawMin(int m) {
+  drawHand(m * 6 + 270, clockRad - MINUTE_HAND_TIP, clockRad - MINUTE_HAND_TAIL, clockRad - MINUTE_HAND_SIDE, MINUTE_HAND_SPREAD);
 }
 
 void drawHour(int h, int m) {
-  float x1, y1, x2, y2, x3, y3, x4, y4;
+  drawHand((h * 30) + (m / 2) + 270, clockRad - HOUR_HAND_TIP, clockRad - HOUR_HAND_TAIL, clockRad - HOUR_HAND_SIDE, HOUR_HAND_SPREAD);
+}
 
-  h = (h * 30) + (m / 2);
-  h = h + 270;
-  
-  x1 = (clockRad - 10) * cos(h * 0.0175);
-  y1 = (clockRad - 10) * sin(h * 0.0175);
-  x2 = (clockRad - 27) * cos(h * 0.0175);
-  y2 = (clockRad - 27) * sin(h * 0.0175);
-  x3 = (clockRad - 22) * cos((h + 12) * 0.0175);
-  y3 = (clockRad - 22) * sin((h + 12) * 0.0175);
-  x4 = (clockRad - 22) * cos((h - 12) * 0.0175);
-  y4 = (clockRad - 22) * sin((h - 12) * 0.0175);
-  
-  u8g2.drawLine(x1 + clockCenterX, y1 + clockCenterY, x3 + clockCenterX, y3 + clockCenterY);
-  u8g2.drawLine(x3 + clockCenterX, y3 + clockCenterY, x2 + clockCenterX, y2 + clockCenterY);
-  u8g2.drawLine(x2 + clockCenterX, y2 + clockCenterY, x4 + clockCenterX, y4 + clockCenterY);
-  u8g2.drawLine(x4 + clockCenterX, y4 + clockCenterY, x1 + clockCenterX, y1 + clockCenterY);
+// Uses the precomputed table when the dial has the geometry of the table
+template <class Table>
+void drawHands(uint8_t h, uint8_t m) {
+  if (!dialOnPage()) {
+    return;
+  }
+
+  if (!Table::matches(clockCenterX, clockCenterY, clockRad)) {
+    drawMin(m);
+    drawHour(h, m);
+    return;
+  }
+
+  drawHandQuad(Table::minute(m));
+  drawHandQuad(Table::hour(h, m));
 }
 
 void drawWatchFace() {
-  // Draw Clockface
-  for (int i=0; i<2; i++) {
-    u8g2.drawCircle(clockCenterX, clockCenterY, clockRad-i);
+  if (!dialOnPage()) {
+    return;
   }
 
-  for (int i=0; i<3; i++) {
-    u8g2.drawCircle(clockCenterX, clockCenterY, i);
-  }
+  // Draw Clockface
+  drawDialRim();
+
+  // Hub
+  drawRing(clockCenterX, clockCenterY, 0, 2);
   
   // Draw a small mark for every hour
   for (int i=0; i<12; i++) {
@@ -304,40 +822,59 @@ void drawWatchFace() {
   }
 }
 
+#ifndef PAGEBUFFER
+
+// The static layer depends on the face and on the dial geometry
+uint32_t backgroundKey(uint8_t face) {
+  return ((uint32_t)face << 24) | ((uint32_t)clockCenterX << 16) | ((uint32_t)clockCenterY << 8) | clockRad;
+}
+
+// Starts a frame with the cached static layer of the face. Returns false
+// with a cleared buffer when the static elements must be drawn and stored.
+bool restoreBackground(uint8_t face) {
+  return backgroundLayer.restore(backgroundKey(face));
+}
+
+void storeBackground(uint8_t face) {
+  backgroundLayer.store(backgroundKey(face));
+}
+
+#endif
+
 void drawEmptyCentralBlock(uint8_t center, uint8_t width, uint8_t top, uint8_t height, uint8_t corner = 0) {
-  u8g2.setColorIndex(0);
+  setDrawColor(0);
   if (corner == 0) {
-    u8g2.drawBox(center - width / 2, top, width, height);
+    drawBox(center - width / 2, top, width, height);
   } else {
-    u8g2.drawRBox(center - width / 2, top, width, height, 3);
+    drawRBox(center - width / 2, top, width, height, 3);
   }
 
-  u8g2.setColorIndex(1);
+  setDrawColor(1);
   if (corner == 0) {
-    u8g2.drawFrame(center - width / 2, top, width, height);
+    drawFrame(center - width / 2, top, width, height);
   } else {
-    u8g2.drawRFrame(center - width / 2, top, width, height, 3);
+    drawRFrame(center - width / 2, top, width, height, 3);
   }
 }
 
 void drawCentralBlock(uint8_t center, uint8_t width, uint8_t top, uint8_t height, uint8_t corner = 0) {
   if (corner == 0) {
-    u8g2.drawFrame(center - width / 2, top, width, height);
+    drawFrame(center - width / 2, top, width, height);
   } else {
-    u8g2.drawRFrame(center - width / 2, top, width, height, 3);
+    drawRFrame(center - width / 2, top, width, height, 3);
   }
 }
 
 void drawCentralLines(uint8_t x, uint8_t y1, uint8_t y2, uint8_t y3) {
-  u8g2.drawLine(x, 16, x, y1 - 2);
-  u8g2.drawLine(x, y1 + 2, x, y2 - 2);
-  u8g2.drawLine(x, y2 + 2, x, y3 - 2);
+  drawLine(x, 16, x, y1 - 2);
+  drawLine(x, y1 + 2, x, y2 - 2);
+  drawLine(x, y2 + 2, x, y3 - 2);
 }
 
 void drawHorisontalLines(uint8_t y1, uint8_t y2, uint8_t y3) {
-  u8g2.drawLine(0, y1, displayWidth, y1);
-  u8g2.drawLine(0, y2, displayWidth, y2);
-  u8g2.drawLine(0, y3, displayWidth, y3);
+  drawHLine(0, y1, displayWidth);
+  drawHLine(0, y2, displayWidth);
+  drawHLine(0, y3, displayWidth);
 }
 
 void drawText(const char *c, uint8_t y, align a, uint8_t offset = 0) {
@@ -346,7 +883,7 @@ void drawText(const char *c, uint8_t y, align a, uint8_t offset = 0) {
   if (a == left) {
     start = 0;
   } else if (a == center) {
-    uint8_t strWidth = u8g2.getStrWidth(c);
+    uint8_t strWidth = textWidthCache.getStrWidth(u8g2.getU8g2(), c);
 
     if (strWidth == 0 || strWidth > displayWidth) {
       start = 0;
@@ -354,7 +891,7 @@ void drawText(const char *c, uint8_t y, align a, uint8_t offset = 0) {
       start = (displayWidth - strWidth) / 2;
     }
   } else if (a == right) {
-    uint8_t strWidth = u8g2.getStrWidth(c);
+    uint8_t strWidth = textWidthCache.getStrWidth(u8g2.getU8g2(), c);
 
     if (strWidth == 0 || strWidth > displayWidth) {
       start = 0;
@@ -363,7 +900,7 @@ void drawText(const char *c, uint8_t y, align a, uint8_t offset = 0) {
     }
   }
   
-  u8g2.drawStr(start + offset, y, c);
+  drawStr(start + offset, y, c);
 }
 
 void drawSeconds(uint8_t s, uint8_t y) {
@@ -376,7 +913,7 @@ void drawSeconds(uint8_t s, uint8_t y) {
 
   uint8_t stepSecond = firstSecond;
   float pixelsInOneSecond = displayWidth / 60;
-  char STRING1[] = "  ";
+  char STRING1[DIGIT_FORMAT_NUMBER_SIZE];
   uint8_t delta = 5; // Need for font size correction
 
   for(size_t i = 0; i < 70; i++) {
@@ -386,8 +923,8 @@ void drawSeconds(uint8_t s, uint8_t y) {
     }
 
     if (stepSecond % 15 == 0) {
-      u8g2.drawLine(i * pixelsInOneSecond, y - 2, i * pixelsInOneSecond, y);
-      sprintf(STRING1, "%d", stepSecond);
+      drawLine(i * pixelsInOneSecond, y - 2, i * pixelsInOneSecond, y);
+      DigitFormat::number(STRING1, stepSecond);
       if (stepSecond == 0) {
         delta = 2;
       } else if (stepSecond == 15) {
@@ -410,7 +947,7 @@ void drawMinutes(uint8_t m, uint8_t y) {
 
   uint8_t stepMinute = firstMinute;
   float pixelsInOneMinute = displayWidth / 60;
-  char STRING1[] = "  ";
+  char STRING1[DIGIT_FORMAT_NUMBER_SIZE];
   uint8_t delta = 5; // Need for font size correction
 
   for(size_t i = 0; i < 70; i++) {
@@ -420,11 +957,11 @@ void drawMinutes(uint8_t m, uint8_t y) {
     }
 
     if (stepMinute % 5 == 0) {
-      u8g2.drawLine(i * pixelsInOneMinute, y - 2, i * pixelsInOneMinute, y);
+      drawLine(i * pixelsInOneMinute, y - 2, i * pixelsInOneMinute, y);
     }
 
     if (stepMinute % 15 == 0) {
-      sprintf(STRING1, "%d", stepMinute);
+      DigitFormat::number(STRING1, stepMinute);
       if (stepMinute == 0) {
         delta = 2;
       } else if (stepMinute == 15) {
@@ -447,7 +984,7 @@ void drawHours(uint8_t h, uint8_t y) {
 
   uint8_t stepHour = firstHour;
   float pixelsInOneHour = displayWidth / 24;
-  char STRING1[] = "  ";
+  char STRING1[DIGIT_FORMAT_NUMBER_SIZE];
   uint8_t delta = 5; // Need for font size correction
 
   for(size_t i = 0; i < 28; i++) {
@@ -456,10 +993,10 @@ void drawHours(uint8_t h, uint8_t y) {
       stepHour = stepHour - 24;
     }
 
-    u8g2.drawLine(i * pixelsInOneHour, y - 2, i * pixelsInOneHour, y);
+    drawLine(i * pixelsInOneHour, y - 2, i * pixelsInOneHour, y);
 
     if (stepHour % 3 == 0) {
-      sprintf(STRING1, "%d", stepHour);
+      DigitFormat::number(STRING1, stepHour);
       if (stepHour <= 10) {
         delta = 2;
       } else {
@@ -470,199 +1007,273 @@ void drawHours(uint8_t h, uint8_t y) {
   }
 }
 
+#ifdef PAGEBUFFER
+
+// Without a full frame buffer the rulers are drawn directly every page
+const uint8_t *rulerFonts[3];
+
+void prepareRulers(const uint8_t *secondsFont, const uint8_t *minutesFont, const uint8_t *hoursFont) {
+  rulerFonts[0] = secondsFont;
+  rulerFonts[1] = minutesFont;
+  rulerFonts[2] = hoursFont;
+}
+
+void drawRuler(void (*drawTicks)(uint8_t, uint8_t), uint8_t value, const uint8_t *font, uint8_t y) {
+  if (pageIntersects(y - (RULER_STRIP_HEIGHT - 1), y)) {
+    setFont(font);
+    drawTicks(value, y);
+  }
+}
+
+void drawRulers(uint8_t line1Y, uint8_t line2Y, uint8_t line3Y) {
+  drawRuler(drawSeconds, localTime.Second, rulerFonts[0], line3Y);
+  drawRuler(drawMinutes, localTime.Minute, rulerFonts[1], line2Y);
+  drawRuler(drawHours, localTime.Hour, rulerFonts[2], line1Y);
+}
+
+#else
+
+// The ruler drawing functions above are only used to render the strips.
+// halfTurn is the value that puts the first tick at the left edge.
+void prepareRuler(RulerStrip &strip, void (*drawRuler)(uint8_t, uint8_t), uint8_t halfTurn, uint8_t pixelsPerStep, uint8_t stepsPerLabel, const uint8_t *font) {
+  if (strip.isRendered(font)) {
+    return;
+  }
+
+  u8g2.clearBuffer();
+  setFontMode(1);
+  setFontDirection(0);
+  setFont(font);
+  drawRuler(halfTurn, RULER_STRIP_HEIGHT - 1);
+  strip.capture(u8g2.getU8g2(), font, halfTurn * 2 * pixelsPerStep, stepsPerLabel * pixelsPerStep);
+}
+
+// Must be called before the frame is started, rendering uses the frame buffer
+void prepareRulers(const uint8_t *secondsFont, const uint8_t *minutesFont, const uint8_t *hoursFont) {
+  prepareRuler(secondsStrip, drawSeconds, 30, displayWidth / 60, 15, secondsFont);
+  prepareRuler(minutesStrip, drawMinutes, 30, displayWidth / 60, 15, minutesFont);
+  prepareRuler(hoursStrip, drawHours, 12, displayWidth / 24, 3, hoursFont);
+}
+
+void drawRuler(RulerStrip &strip, uint8_t value, uint8_t halfTurn, uint8_t pixelsPerStep, uint8_t y) {
+  uint8_t first = value < halfTurn ? value + halfTurn : value - halfTurn;
+  strip.draw(u8g2.getU8g2(), first * pixelsPerStep, y);
+}
+
+void drawRulers(uint8_t line1Y, uint8_t line2Y, uint8_t line3Y) {
+  drawRuler(secondsStrip, localTime.Second, 30, displayWidth / 60, line3Y);
+  drawRuler(minutesStrip, localTime.Minute, 30, displayWidth / 60, line2Y);
+  drawRuler(hoursStrip, localTime.Hour, 12, displayWidth / 24, line1Y);
+}
+
+#endif
+
 void drawCurrentTimeInBlock(uint8_t center, uint8_t width, uint8_t y1, uint8_t y2, uint8_t y3, uint8_t h, uint8_t m, uint8_t s) {
-  char HOUR[] = "  ";
-  sprintf(HOUR, "%02d", h);
+  char HOUR[DIGIT_FORMAT_TWO_SIZE];
+  DigitFormat::twoDigits(HOUR, h);
 
-  char MINUTE[] = "  ";
-  sprintf(MINUTE, "%02d", m);
+  char MINUTE[DIGIT_FORMAT_TWO_SIZE];
+  DigitFormat::twoDigits(MINUTE, m);
 
-  char SECOND[] = "  ";
-  sprintf(SECOND, "%02d", s);
+  char SECOND[DIGIT_FORMAT_TWO_SIZE];
+  DigitFormat::twoDigits(SECOND, s);
 
-  u8g2.drawStr(center - width / 2 + 1, y1, HOUR);
-  u8g2.drawStr(center - width / 2 + 1, y2, MINUTE);
-  u8g2.drawStr(center - width / 2 + 1, y3, SECOND);
+  // Digits are 9 rows high
+  if (pageIntersects(y1 - 8, y1)) {
+    drawStr(center - width / 2 + 1, y1, HOUR);
+  }
+  if (pageIntersects(y2 - 8, y2)) {
+    drawStr(center - width / 2 + 1, y2, MINUTE);
+  }
+  if (pageIntersects(y3 - 8, y3)) {
+    drawStr(center - width / 2 + 1, y3, SECOND);
+  }
 }
 
 void drawTopBar(const char *c, const uint8_t *font, uint8_t y) {
-  u8g2.setFont(font);
+  setFont(font);
   drawText(c, y, left);
 
-  u8g2.setFont(u8g2_font_open_iconic_www_1x_t);
+  setFont(u8g2_font_open_iconic_www_1x_t);
   if (transferData){
-    u8g2.drawGlyph(displayWidth - 8, y, icons[5]);
+    drawGlyph(displayWidth - 8, y, icons[5]);
   } else {
     if (WiFi.status() == WL_CONNECTED) {
-      u8g2.drawGlyph(displayWidth - 8, y, icons[1]);
+      drawGlyph(displayWidth - 8, y, icons[1]);
     } else {
-      u8g2.drawGlyph(displayWidth - 8, y, icons[0]);
+      drawGlyph(displayWidth - 8, y, icons[0]);
     }
   }
 }
 
-void drawModeOne() {
-  char STRING1[] = "                ";
-  sprintf(STRING1, "%s %02d %04d, %s", monthName[localTime.Month - 1], localTime.Day, tmYearToCalendar(localTime.Year), dayName[localTime.Wday]);
-
-  char STRING2[] = "     ";
-  sprintf(STRING2, "%02d:%02d", localTime.Hour, localTime.Minute);
+// Ruler lines of face 4 and of faces 5 and 6
+const uint8_t rulerLinesWide[3] = {30, 47, 63};
+const uint8_t rulerLinesNarrow[3] = {31, 46, 60};
 
-  char STRING3[] = "  ";
-  sprintf(STRING3, "%02d", localTime.Second);
+void drawDateBar() {
+  if (!pageIntersects(0, 13)) {
+    return;
+  }
 
-  u8g2.clearBuffer();
-  u8g2.setFontMode(1);
-  u8g2.setFontDirection(0);
+  char STRING1[DIGIT_FORMAT_DATE_SIZE];
+  DigitFormat::date(STRING1, monthName[localTime.Month - 1], localTime.Day, tmYearToCalendar(localTime.Year), dayName[localTime.Wday]);
 
   drawTopBar(STRING1, u8g2_font_7x14B_tf, 10);
+}
 
-  u8g2.setFont(u8g2_font_logisoso22_tn);
-  drawText(STRING2, 38, center);
-  u8g2.setFont(u8g2_font_logisoso16_tf);
-  drawText(STRING3, 63, center);
+void drawDigitalTime(align a, uint8_t secondsOffset) {
+  char STRING2[DIGIT_FORMAT_TIME_SIZE];
+  DigitFormat::time(STRING2, localTime.Hour, localTime.Minute);
 
-  u8g2.sendBuffer();
-}
+  char STRING3[DIGIT_FORMAT_TWO_SIZE];
+  DigitFormat::twoDigits(STRING3, localTime.Second);
 
-void drawModeTwo() {
-  clockCenterX = displayWidth / 2;
-  clockCenterY = 39;
+  if (pageIntersects(16, 38)) {
+    setFont(u8g2_font_logisoso22_tn);
+    drawText(STRING2, 38, a);
+  }
 
-  char STRING1[] = "                ";
-  sprintf(STRING1, "%s %02d %04d, %s", monthName[localTime.Month - 1], localTime.Day, tmYearToCalendar(localTime.Year), dayName[localTime.Wday]);
+  if (pageIntersects(47, 63)) {
+    setFont(u8g2_font_logisoso16_tf);
+    drawText(STRING3, 63, a, secondsOffset);
+  }
+}
 
-  u8g2.clearBuffer();
-  u8g2.setFontMode(1);
-  u8g2.setFontDirection(0);
+// Face 1: date and digital time
+void drawModeOneDynamic() {
+  drawDateBar();
+  drawDigitalTime(center, 0);
+}
 
-  drawTopBar(STRING1, u8g2_font_7x14B_tf, 10);
+// Face 2: analog dial in the middle
+void prepareModeTwo() {
+  clockCenterX = displayWidth / 2;
+  clockCenterY = 39;
+}
 
-  drawWatchFace();
+void drawModeTwoDynamic() {
+  drawDateBar();
   drawSec(localTime.Second);
-  drawMin(localTime.Minute);
-  drawHour(localTime.Hour, localTime.Minute);
-
-  u8g2.sendBuffer();
+  drawHands<CenterDialHands>(localTime.Hour, localTime.Minute);
 }
 
-void drawModeThree() {
+// Face 3: digital time with the analog dial on the right
+void prepareModeThree() {
   clockCenterX = displayWidth - clockRad - 1;
   clockCenterY = 39;
+}
 
-  char STRING1[] = "                ";
-  sprintf(STRING1, "%s %02d %04d, %s", monthName[localTime.Month - 1], localTime.Day, tmYearToCalendar(localTime.Year), dayName[localTime.Wday]);
-
-  char STRING2[] = "     ";
-  sprintf(STRING2, "%02d:%02d", localTime.Hour, localTime.Minute);
-
-  char STRING3[] = "  ";
-  sprintf(STRING3, "%02d", localTime.Second);
-
-  u8g2.clearBuffer();
-  u8g2.setFontMode(1);
-  u8g2.setFontDirection(0);
-
-  drawTopBar(STRING1, u8g2_font_7x14B_tf, 10);
-
-  u8g2.setFont(u8g2_font_logisoso22_tn);
-  drawText(STRING2, 38, left);
-  u8g2.setFont(u8g2_font_logisoso16_tf);
-  drawText(STRING3, 63, left, 25);
-  
-  drawWatchFace();
+void drawModeThreeDynamic() {
+  drawDateBar();
+  drawDigitalTime(left, 25);
   drawSec(localTime.Second);
-  drawMin(localTime.Minute);
-  drawHour(localTime.Hour, localTime.Minute);
-
-  u8g2.sendBuffer();
+  drawHands<RightDialHands>(localTime.Hour, localTime.Minute);
 }
 
-void drawModeFour() {
-  char STRING1[] = "                ";
-  sprintf(STRING1, "%s %02d %04d, %s", monthName[localTime.Month - 1], localTime.Day, tmYearToCalendar(localTime.Year), dayName[localTime.Wday]);
-
-  u8g2.clearBuffer();
-  u8g2.setFontMode(1);
-  u8g2.setFontDirection(0);
-
-  drawTopBar(STRING1, u8g2_font_7x14B_tf, 10);
-
-  uint8_t line1Y = 30;
-  uint8_t line2Y = 47;
-  uint8_t line3Y = 63;
-  drawCentralLines(displayWidth / 2, line1Y, line2Y, line3Y);
-  drawHorisontalLines(line1Y, line2Y, line3Y);
+// Face 4: rulers under a central line
+void prepareModeFour() {
+  prepareRulers(u8g2_font_haxrcorp4089_tn, u8g2_font_glasstown_nbp_tn, u8g2_font_glasstown_nbp_tn);
+}
 
-  u8g2.setFont(u8g2_font_haxrcorp4089_tn);
-  drawSeconds(localTime.Second, line3Y);
-  u8g2.setFont(u8g2_font_glasstown_nbp_tn);
-  drawMinutes(localTime.Minute, line2Y);
-  drawHours(localTime.Hour, line1Y);
+void drawModeFourStatic() {
+  drawCentralLines(displayWidth / 2, rulerLinesWide[0], rulerLinesWide[1], rulerLinesWide[2]);
+  drawHorisontalLines(rulerLinesWide[0], rulerLinesWide[1], rulerLinesWide[2]);
+}
 
-  u8g2.sendBuffer();
+void drawModeFourDynamic() {
+  drawDateBar();
+  drawRulers(rulerLinesWide[0], rulerLinesWide[1], rulerLinesWide[2]);
 }
 
-void drawModeFive() {
-  char STRING1[] = "                ";
-  sprintf(STRING1, "%s %02d %04d, %s", monthName[localTime.Month - 1], localTime.Day, tmYearToCalendar(localTime.Year), dayName[localTime.Wday]);
+// Face 5: rulers under a central frame
+void prepareModeFiveSix() {
+  prepareRulers(u8g2_font_haxrcorp4089_tn, u8g2_font_haxrcorp4089_tn, u8g2_font_haxrcorp4089_tn);
+}
 
-  u8g2.clearBuffer();
-  u8g2.setFontMode(1);
-  u8g2.setFontDirection(0);
+void drawModeFiveStatic() {
+  drawHorisontalLines(rulerLinesNarrow[0], rulerLinesNarrow[1], rulerLinesNarrow[2]);
+  drawCentralBlock(displayWidth / 2, 14, 16, displayHeight - 16, 3);
+}
 
-  drawTopBar(STRING1, u8g2_font_7x14B_tf, 10);
+void drawModeFiveDynamic() {
+  drawDateBar();
+  drawRulers(rulerLinesNarrow[0], rulerLinesNarrow[1], rulerLinesNarrow[2]);
+}
 
-  uint8_t line1Y = 31;
-  uint8_t line2Y = 46;
-  uint8_t line3Y = 60;
-  drawHorisontalLines(line1Y, line2Y, line3Y);
+// Face 6: rulers with the digits in a central block
+void drawModeSixStatic() {
+  drawHorisontalLines(rulerLinesNarrow[0], rulerLinesNarrow[1], rulerLinesNarrow[2]);
+}
 
-  u8g2.setFont(u8g2_font_haxrcorp4089_tn);
-  drawSeconds(localTime.Second, line3Y);
-  drawMinutes(localTime.Minute, line2Y);
-  drawHours(localTime.Hour, line1Y);
+void drawModeSixDynamic() {
+  drawDateBar();
+  drawRulers(rulerLinesNarrow[0], rulerLinesNarrow[1], rulerLinesNarrow[2]);
 
-  drawCentralBlock(displayWidth / 2, 14, 16, displayHeight - 16, 3);
+  // The central block covers the rulers, so it is drawn with the dynamic part
+  drawEmptyCentralBlock(displayWidth / 2, 19, 16, displayHeight - 16, 3);
 
-  u8g2.sendBuffer();
+  setFont(u8g2_font_profont12_tn);
+  drawCurrentTimeInBlock(displayWidth / 2, 13, rulerLinesNarrow[0] - 3, rulerLinesNarrow[1] - 3, rulerLinesNarrow[2] - 3, localTime.Hour, localTime.Minute, localTime.Second);
 }
 
-void drawModeSix() {
-  char STRING1[] = "                ";
-  sprintf(STRING1, "%s %02d %04d, %s", monthName[localTime.Month - 1], localTime.Day, tmYearToCalendar(localTime.Year), dayName[localTime.Wday]);
+// Every face shows seconds, the date and the WiFi icon. The RTC is read
+// twice per second, so a shorter period would not show anything new.
+#define FACE_DEPENDENCIES (RENDER_DEPENDS_TIME | RENDER_DEPENDS_DATE | RENDER_DEPENDS_WIFI | RENDER_DEPENDS_TRANSFER)
+#define FACE_PERIOD 500
+
+const WatchFace watchFaceTable[] = {
+  { NULL,               NULL,                drawModeOneDynamic,   FACE_DEPENDENCIES, FACE_PERIOD },
+  { prepareModeTwo,     drawWatchFace,       drawModeTwoDynamic,   FACE_DEPENDENCIES, FACE_PERIOD },
+  { prepareModeThree,   drawWatchFace,       drawModeThreeDynamic, FACE_DEPENDENCIES, FACE_PERIOD },
+  { prepareModeFour,    drawModeFourStatic,  drawModeFourDynamic,  FACE_DEPENDENCIES, FACE_PERIOD },
+  { prepareModeFiveSix, drawModeFiveStatic,  drawModeFiveDynamic,  FACE_DEPENDENCIES, FACE_PERIOD },
+  { prepareModeFiveSix, drawModeSixStatic,   drawModeSixDynamic,   FACE_DEPENDENCIES, FACE_PERIOD }
+};
 
-  u8g2.clearBuffer();
-  u8g2.setFontMode(1);
-  u8g2.setFontDirection(0);
+void drawWatchFaceFrame(uint8_t id) {
+  const WatchFace *face = watchFaces.get(id);
 
-  drawTopBar(STRING1, u8g2_font_7x14B_tf, 10);
+  if (face == NULL) {
+    return;
+  }
 
-  uint8_t line1Y = 31;
-  uint8_t line2Y = 46;
-  uint8_t line3Y = 60;
-  drawHorisontalLines(line1Y, line2Y, line3Y);
+  if (face->prepare != NULL) {
+    face->prepare();
+  }
 
-  u8g2.setFont(u8g2_font_haxrcorp4089_tn);
-  drawSeconds(localTime.Second, line3Y);
-  drawMinutes(localTime.Minute, line2Y);
-  drawHours(localTime.Hour, line1Y);
+  #ifdef PAGEBUFFER
+  // Without the cached layer both parts are drawn for every page
+  renderFrame([face]() {
+    setFontMode(1);
+    setFontDirection(0);
 
-  drawEmptyCentralBlock(displayWidth / 2, 19, 16, displayHeight - 16, 3);
+    if (face->drawStatic != NULL) {
+      face->drawStatic();
+    }
+    face->drawDynamic();
+  });
+  #else
+  if (!restoreBackground(id)) {
+    if (face->drawStatic != NULL) {
+      face->drawStatic();
+    }
+    storeBackground(id);
+  }
 
-  u8g2.setFont(u8g2_font_profont12_tn);
-  drawCurrentTimeInBlock(displayWidth / 2, 13, line1Y - 3, line2Y - 3, line3Y - 3, localTime.Hour, localTime.Minute, localTime.Second);
+  setFontMode(1);
+  setFontDirection(0);
+  face->drawDynamic();
 
-  u8g2.sendBuffer();
+  sendFrame();
+  #endif
 }
 
-void drawFirmwareUpdateMode() {
-  u8g2.clearBuffer();
-  u8g2.setFontMode(1);
-  u8g2.setFontDirection(0);
+void drawFirmwareUpdateScreen() {
+  setFontMode(1);
+  setFontDirection(0);
 
   drawTopBar("Mirror Clock", u8g2_font_7x14B_tf, 10);
-  u8g2.setFont(u8g2_font_7x14B_tf);
+  setFont(u8g2_font_7x14B_tf);
   char VERSION[] = "Version: 0.0";
   sprintf(VERSION, "Version: %s", VER);
   drawText(VERSION, 26, left);
@@ -689,38 +1300,40 @@ void drawFirmwareUpdateMode() {
       break;
   }
 
-  u8g2.setFont(u8g2_font_open_iconic_www_2x_t);
-  u8g2.drawGlyph(displayWidth - 16, displayHeight, icons[11]);
+  setFont(u8g2_font_open_iconic_www_2x_t);
+  drawGlyph(displayWidth - 16, displayHeight, icons[11]);
+}
 
-  u8g2.sendBuffer();
+void drawFirmwareUpdateMode() {
+  renderFrame(drawFirmwareUpdateScreen);
 }
 
-void drawRebootingMode() {
-  u8g2.clearBuffer();
-  u8g2.setFontMode(1);
-  u8g2.setFontDirection(0);
+void drawRebootingScreen() {
+  setFontMode(1);
+  setFontDirection(0);
 
   drawTopBar("Mirror Clock", u8g2_font_7x14B_tf, 10);
-  u8g2.setFont(u8g2_font_7x14B_tf);
+  setFont(u8g2_font_7x14B_tf);
   char VERSION[] = "Version: 0.0";
   sprintf(VERSION, "Version: %s", VER);
   drawText(VERSION, 26, left);
   drawText("Firmware update", 42, left);
   drawText("Rebooting...", 58, left);
 
-  u8g2.setFont(u8g2_font_open_iconic_embedded_2x_t);
-  u8g2.drawGlyph(displayWidth - 16, displayHeight, icons[12]);
+  setFont(u8g2_font_open_iconic_embedded_2x_t);
+  drawGlyph(displayWidth - 16, displayHeight, icons[12]);
+}
 
-  u8g2.sendBuffer();
+void drawRebootingMode() {
+  renderFrame(drawRebootingScreen);
 }
 
-void drawFWErrorMode() {
-  u8g2.clearBuffer();
-  u8g2.setFontMode(1);
-  u8g2.setFontDirection(0);
+void drawFWErrorScreen() {
+  setFontMode(1);
+  setFontDirection(0);
 
   drawTopBar("Mirror Clock", u8g2_font_7x14B_tf, 10);
-  u8g2.setFont(u8g2_font_7x14B_tf);
+  setFont(u8g2_font_7x14B_tf);
   drawText("Firmware update", 26, left);
   drawText("End with error", 42, left);
   
@@ -744,87 +1357,156 @@ void drawFWErrorMode() {
     default:
       break;
   }
+}
 
-  u8g2.sendBuffer();
+void drawFWErrorMode() {
+  renderFrame(drawFWErrorScreen);
 }
 
-void displayCurrentTime() {
+uint8_t currentScreen() {
   if (firmwareUpdateOTA) {
+    return SCREEN_FIRMWARE_UPDATE;
+  }
+
+  if (rebooting) {
+    return SCREEN_REBOOTING;
+  }
+
+  if (uploadingError) {
+    return SCREEN_FIRMWARE_ERROR;
+  }
+
+  if (!timeCorrect) {
+    return SCREEN_TIME_ERROR;
+  }
+
+  return watchFaces.getCurrentId();
+}
+
+// Unknown screens draw nothing, so they depend on nothing and have no period
+uint8_t screenDependencies(uint8_t screen) {
+  const WatchFace *face;
+
+  switch (screen) {
+    case SCREEN_TIME_ERROR:
+      // "DS1307 is stopped" or "DS1307 read error"
+      return RENDER_DEPENDS_RTC;
+
+    case SCREEN_FIRMWARE_UPDATE:
+    case SCREEN_REBOOTING:
+    case SCREEN_FIRMWARE_ERROR:
+      return RENDER_DEPENDS_OTA | RENDER_DEPENDS_WIFI | RENDER_DEPENDS_TRANSFER;
+
+    default:
+      face = watchFaces.get(screen);
+      return face != NULL ? face->dependencies : 0;
+  }
+}
+
+uint16_t screenUpdatePeriod(uint8_t screen) {
+  const WatchFace *face = watchFaces.get(screen);
+  return face != NULL ? face->minUpdatePeriod : 0;
+}
+
+void renderScreen(uint8_t screen) {
+  if (screen == SCREEN_FIRMWARE_UPDATE) {
     drawFirmwareUpdateMode();
     return;
   }
 
-  if (rebooting) {
+  if (screen == SCREEN_REBOOTING) {
     drawRebootingMode();
     return;
   }
 
-  if (uploadingError) {
+  if (screen == SCREEN_FIRMWARE_ERROR) {
     drawFWErrorMode();
     return;
   }
 
-  if (!timeCorrect) {
-    u8g2.clearBuffer();
-    u8g2.setFontMode(1);
-    u8g2.setFontDirection(0);
-    u8g2.setFont(u8g2_font_7x14B_tf);
+  if (screen == SCREEN_TIME_ERROR) {
+    // Set by readCurrentTime(), so the RTC is only used inside its bus
+    // transaction
+    bool chipPresent = rtcPresent;
 
-    if (RTC.chipPresent()) {
+    if (chipPresent) {
       Serial.println("The DS1307 is stopped.  Please run the SetTime");
-      drawText("DS1307 is stopped", 10, center);
-      drawText("Run the SetTime", 26, center);
     } else {
       Serial.println("DS1307 read error!  Please check the circuitry.");
-      drawText("DS1307 read error", 10, center);
-      drawText("Check circuitry", 26, center);
     }
 
-    u8g2.sendBuffer();
+    renderFrame([chipPresent]() {
+      setFontMode(1);
+      setFontDirection(0);
+      setFont(u8g2_font_7x14B_tf);
+
+      if (chipPresent) {
+        drawText("DS1307 is stopped", 10, center);
+        drawText("Run the SetTime", 26, center);
+      } else {
+        drawText("DS1307 read error", 10, center);
+        drawText("Check circuitry", 26, center);
+      }
+    });
 
     return;
   }
 
-  switch (currentWatchFace)
-  {
-    case 1:
-      drawModeOne();
-      break;
+  drawWatchFaceFrame(screen);
+}
 
-    case 2:
-      drawModeTwo();
-      break;
+// Draws a frame only when something the current screen shows has changed.
+// The frame is sent before this returns.
+void displayCurrentTime() {
+  // The frame buffer still holds the frame in flight
+  finishFrame();
+
+  RenderInputs inputs;
+  inputs.screen = currentScreen();
+  inputs.second = localTime.Second;
+  inputs.minute = localTime.Minute;
+  inputs.hour = localTime.Hour;
+  inputs.day = localTime.Day;
+  inputs.month = localTime.Month;
+  inputs.year = localTime.Year;
+  inputs.dayOfWeek = localTime.Wday;
+  inputs.wifiConnected = WiFi.status() == WL_CONNECTED;
+  inputs.transferData = transferData;
+  inputs.otaState = (uint8_t)uploadStatus | (uploadingErrorCode << 4);
+  inputs.rtcPresent = rtcPresent;
+
+  if (!renderScheduler.shouldRender(inputs, screenDependencies(inputs.screen), screenUpdatePeriod(inputs.screen))) {
+    return;
+  }
 
-    case 3:
-      drawModeThree();
-      break;
+  #ifdef DISPLAYSTATS
+  uint32_t renderStart = micros();
+  #endif
 
-    case 4:
-      drawModeFour();
-      break;
+  renderScreen(inputs.screen);
 
-    case 5:
-      drawModeFive();
-      break;
+  // With PAGEBUFFER the time includes the transfer
+  #ifdef DISPLAYSTATS
+  Serial.printf("Render: %u us, free heap %u bytes\n", micros() - renderStart, ESP.getFreeHeap());
+  #endif
+}
 
-    case 6:
-      drawModeSix();
-      break;
-  
-    default:
-      drawModeOne();
-      break;
+// Timer driven refresh, the frame is sent in slices by pollFrame()
+void refreshDisplay() {
+  // A new frame has to wait until the one in flight is on the display
+  if (frameInFlight()) {
+    return;
   }
+
+  sliceFrames = true;
+  displayCurrentTime();
+  sliceFrames = false;
 }
 
 #ifdef DEMOMODE
 
 void changeWatchFace() {
-  currentWatchFace++;
-  
-  if (currentWatchFace > totalWatchFaces || currentWatchFace < 1) {
-    currentWatchFace = 1;
-  }
+  watchFaces.next();
 }
 
 #endif
@@ -835,33 +1517,97 @@ void changeWatchFace() {
 */
 
 
+#ifdef SETTIME
+
+// Result lines are left out when NULL
+void drawSetTimeScreen(const char *line1, const char *line2) {
+  renderFrame([&]() {
+    setFontMode(1);
+    setFontDirection(0);
+    setFont(u8g2_font_7x14B_tf);
+    drawText("Set time", 10, center);
+
+    if (line1 != NULL) {
+      drawText(line1, 26, center);
+    }
+    if (line2 != NULL) {
+      drawText(line2, 42, center);
+    }
+  });
+}
+
+#endif
+
+// The link icon next to the status is left out when 0
+void drawWiFiScreen(const char *status, uint16_t linkIcon) {
+  renderFrame([&]() {
+    setFont(u8g2_font_open_iconic_www_1x_t);
+    drawGlyph(displayWidth - 8, 8, icons[2]);
+    if (linkIcon != 0) {
+      drawGlyph(displayWidth - 8, 58, linkIcon);
+    }
+
+    setFont(u8g2_font_7x14B_tf);
+    drawText("Mirror Clock", 10, left);
+    drawText("Configuring WiFi", 26, left);
+    drawText("WiFi:", 42, left);
+    drawText(ssid, 42, left, 36);
+    drawText(status, 58, left);
+  });
+}
+
+
 void setup() {
   Serial.begin(9600);
   Serial.println("Mirror clock starting");
 
+  // I2C devices
+  rtcDevice = i2cBus.addDevice(RTC_I2C_ADDRESS, RTC_I2C_CLOCK);
+  displayDevice = i2cBus.attachDisplay(u8g2.getU8x8(), DISPLAY_I2C_CLOCK);
+
   // OLED initialize
+  DisplayBus::begin(u8g2.getU8x8());
   u8g2.begin();
+  #ifndef PAGEBUFFER
+  displayTransport.begin(u8g2.getU8g2());
+  backgroundLayer.begin(u8g2.getU8g2());
+  #endif
+  #ifdef SCREENMIRROR
+  screenMirror.begin(u8g2.getU8g2());
+  #endif
+  textWidthCache.addMonospaceFont(u8g2_font_7x14B_tf);
+  textWidthCache.addMonospaceFont(u8g2_font_profont12_tn);
+  #ifdef FONTSUBSET_RAW
+  glyphCache.addFont(u8g2_font_logisoso22_tn, u8g2_font_logisoso22_tn_raw);
+  glyphCache.addFont(u8g2_font_logisoso16_tf, u8g2_font_logisoso16_tf_raw);
+  #else
+  glyphCache.addFont(u8g2_font_logisoso22_tn);
+  glyphCache.addFont(u8g2_font_logisoso16_tf);
+  #endif
+  glyphIndex.setCache(&glyphCache);
 
   displayHeight = u8g2.getDisplayHeight();
   displayWidth = u8g2.getDisplayWidth();
 
-  u8g2.clearBuffer();
-  u8g2.setFontMode(1);
-  u8g2.setFontDirection(0);
-  u8g2.setFont(u8g2_font_7x14B_tf);
-  drawText("Mirror Clock", 10, center);
+  watchFaces.begin(watchFaceTable, sizeof(watchFaceTable) / sizeof(watchFaceTable[0]));
+  watchFaces.select(defaultWatchFace);
 
   char VERSION[] = "Version: 0.0";
   sprintf(VERSION, "Version: %s", VER);
-  drawText(VERSION, 26, center);
-  drawText("(C) Clevik", 42, center);
-  
-  #ifdef DEMOMODE
-  u8g2.setFont(u8g2_font_smart_patrol_nbp_tf);
-  drawText("Demo mode", 63, right);
-  #endif
 
-  u8g2.sendBuffer();
+  renderFrame([&]() {
+    setFontMode(1);
+    setFontDirection(0);
+    setFont(u8g2_font_7x14B_tf);
+    drawText("Mirror Clock", 10, center);
+    drawText(VERSION, 26, center);
+    drawText("(C) Clevik", 42, center);
+
+    #ifdef DEMOMODE
+    setFont(u8g2_font_smart_patrol_nbp_tf);
+    drawText("Demo mode", 63, right);
+    #endif
+  });
 
   // Update time
   updateCurrentTime();
@@ -874,19 +1620,19 @@ void setup() {
   bool config=false;
   Serial.println("Set time");
 
-  u8g2.clearBuffer();
-  u8g2.setFontMode(1);
-  u8g2.setFontDirection(0);
-  u8g2.setFont(u8g2_font_7x14B_tf);
-  drawText("Set time", 10, center);
-  u8g2.sendBuffer();
+  drawSetTimeScreen(NULL, NULL);
 
   // get the date and time the compiler was run
   if (getDate(__DATE__) && getTime(__TIME__) && getDayOfWeek("3")) {
     parse = true;
     // and configure the RTC with this info
-    if (RTC.write(localTime)) {
-      config = true;
+    i2cBus.beginTransaction(rtcDevice);
+    config = RTC.write(localTime);
+    // A failed write is counted as stopped after the first transaction
+    if (config) {
+      i2cBus.endTransaction(rtcDevice, RTC_WRITE_TIME_BYTES + RTC_WRITE_SECONDS_BYTES, 2);
+    } else {
+      i2cBus.endTransaction(rtcDevice, RTC_WRITE_TIME_BYTES, 1);
     }
   }
   
@@ -898,16 +1644,13 @@ void setup() {
     Serial.print(", Date=");
     Serial.println(__DATE__);
 
-    drawText("DS1307 configured", 26, center);
-    u8g2.sendBuffer();
+    drawSetTimeScreen("DS1307 configured", NULL);
 
   } else if (parse) {
     Serial.println("DS1307 Communication Error :-{");
     Serial.println("Please check your circuitry");
 
-    drawText("Communication Err", 26, center);
-    drawText("Check circuitry", 42, center);
-    u8g2.sendBuffer();
+    drawSetTimeScreen("Communication Err", "Check circuitry");
   } else {
     Serial.print("Could not parse info from the compiler, Time=\"");
     Serial.print(__TIME__);
@@ -915,9 +1658,7 @@ void setup() {
     Serial.print(__DATE__);
     Serial.println("\"");
     
-    drawText("Could not parse", 26, center);
-    drawText("DATE and TIME", 42, center);
-    u8g2.sendBuffer();
+    drawSetTimeScreen("Could not parse", "DATE and TIME");
   }
 
   delay (3000);
@@ -926,7 +1667,8 @@ void setup() {
 
   // Timers initialize
   updateCurrentTimeTimer.every(500, updateCurrentTime);
-  displayCurrentTimeTimer.every(500, displayCurrentTime);
+  // Only checks for changes, a frame is drawn when the screen content changes
+  displayCurrentTimeTimer.every(100, refreshDisplay);
   
   #ifdef DEMOMODE
   changeWatchFaceTimer.every(30000, changeWatchFace);
@@ -936,17 +1678,7 @@ void setup() {
   Serial.print("Connecting to ");
   Serial.println(ssid);
 
-  u8g2.clearBuffer();
-  u8g2.setFont(u8g2_font_open_iconic_www_1x_t);
-  u8g2.drawGlyph(displayWidth - 8, 8, icons[2]);
-  u8g2.drawGlyph(displayWidth - 8, 58, icons[0]); // 0 broken chain, 3 - chain
-  u8g2.setFont(u8g2_font_7x14B_tf);
-  drawText("Mirror Clock", 10, left);
-  drawText("Configuring WiFi", 26, left);
-  drawText("WiFi:", 42, left);
-  drawText(ssid, 42, left, 36);
-  drawText("Attempt 1/10", 58, left);
-  u8g2.sendBuffer();
+  drawWiFiScreen("Attempt 1/10", icons[0]); // 0 broken chain, 3 - chain
 
   WiFi.mode(WIFI_STA);
   WiFi.begin(ssid, password);
@@ -958,22 +1690,11 @@ void setup() {
     Serial.print(".");
     sprintf(STRING1, "Attempt %d/10", (int)(attempt / 2) + 1);
     
-    u8g2.clearBuffer();
-    u8g2.setFont(u8g2_font_open_iconic_www_1x_t);
-    u8g2.drawGlyph(displayWidth - 8, 8, icons[2]);
     if (attempt %2 == 0) {
-      u8g2.drawGlyph(displayWidth - 8, 58, icons[0]);
+      drawWiFiScreen(STRING1, icons[0]);
     } else {
-      u8g2.drawGlyph(displayWidth - 8, 58, icons[3]);
+      drawWiFiScreen(STRING1, icons[3]);
     }
-    
-    u8g2.setFont(u8g2_font_7x14B_tf);
-    drawText("Mirror Clock", 10, left);
-    drawText("Configuring WiFi", 26, left);
-    drawText("WiFi:", 42, left);
-    drawText(ssid, 42, left, 36);
-    drawText(STRING1, 58, left);
-    u8g2.sendBuffer();
 
     attempt = attempt + 1;
     if (attempt > 20) {
@@ -991,16 +1712,7 @@ void setup() {
     Serial.println("IP address: ");
     Serial.println(WiFi.localIP());
 
-    u8g2.clearBuffer();
-    u8g2.setFont(u8g2_font_open_iconic_www_1x_t);
-    u8g2.drawGlyph(displayWidth - 8, 8, icons[2]);
-    u8g2.setFont(u8g2_font_7x14B_tf);
-    drawText("Mirror Clock", 10, left);
-    drawText("Configuring WiFi", 26, left);
-    drawText("WiFi:", 42, left);
-    drawText(ssid, 42, left, 36);
-    drawText("WiFi connected", 58, left);
-    u8g2.sendBuffer();
+    drawWiFiScreen("WiFi connected", 0);
 
     delay(2000);
   }
@@ -1125,12 +1837,38 @@ void setup() {
     yield();
   });
 
+  #ifdef DISPLAYPROFILE
+  server.on("/profile", HTTP_GET, [](){
+    server.sendHeader("Connection", "close");
+    server.send(200, "text/plain", displayProfiler.getReport());
+  });
+  #endif
+
+  #ifdef SCREENMIRROR
+  server.on("/screen", HTTP_GET, [](){
+    server.sendHeader("Connection", "close");
+    server.send(200, "text/html", page.getScreenPage());
+  });
+
+  server.on("/frame", HTTP_GET, [](){
+    uint32_t seq = strtoul(server.arg("seq").c_str(), NULL, 10);
+
+    server.sendHeader("Connection", "close");
+    server.sendHeader("Cache-Control", "no-store");
+    server.sendHeader("X-Bytes-Per-Second", String(screenMirror.getBytesPerSecond()));
+    server.setContentLength(screenMirror.measure(seq));
+    server.send(200, "application/octet-stream", "");
+    screenMirror.write(seq, server.client());
+  });
+  #endif
+
   server.begin();
 }
 
 void loop(void) {
   updateCurrentTimeTimer.update();
   displayCurrentTimeTimer.update();
+  pollFrame();
   server.handleClient();
 
   #ifdef DEMOMODE
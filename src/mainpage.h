@@ -81,6 +81,27 @@ public:
     return result;
   };
 
+  // Live copy of the display, fed by /frame. Every answer is applied to the
+  // local copy of the frame buffer and the next one is requested after
+  // refresh ms.
+  String getScreenPage(uint16_t refresh = 200) {
+    String result = "<html><head><meta charset='UTF-8'><title>Screen</title></head><body><font face='sans-serif'><div><h2>Screen:</h2>";
+    result = result + "<canvas id='screen' width='512' height='256' style='background:#000'></canvas><br><span id='rate'></span></div></font>";
+    result = result + "<script>var ctx=document.getElementById('screen').getContext('2d'),buf=new Uint8Array(0),seq=0;";
+    result = result + "function draw(w,h){ctx.fillStyle='#000';ctx.fillRect(0,0,512,256);ctx.fillStyle='#fff';";
+    result = result + "for(var y=0;y<h;y++)for(var x=0;x<w;x++)if((buf[(y>>3)*w+x]>>(y&7))&1)ctx.fillRect(x*512/w,y*256/h,512/w,256/h);}";
+    result = result + "function next(){fetch('/frame?seq='+seq,{cache:'no-store'}).then(function(r){";
+    result = result + "document.getElementById('rate').innerHTML=r.headers.get('X-Bytes-Per-Second')+' bytes/s';return r.arrayBuffer();}).then(function(a){";
+    result = result + "var d=new Uint8Array(a),w=d[5]*8,h=d[6]*8,i=7,p=0,n,k;";
+    result = result + "if(d[0]==75||buf.length!=w*h/8)buf=new Uint8Array(w*h/8);";
+    result = result + "seq=(d[1]|d[2]<<8|d[3]<<16|d[4]<<24)>>>0;";
+    result = result + "while(i<d.length){n=(d[i]&127)+1;if(d[i++]&128){for(k=0;k<n;k++)buf[p++]^=d[i++];}else{p+=n;}}";
+    result = result + "draw(w,h);setTimeout(next,";
+    result = result + refresh;
+    result = result + ");}).catch(function(){seq=0;setTimeout(next,1000);});}next();</script></body></html>";
+    return result;
+  }
+
   String getRefresh(IPAddress addr, uint8_t sec = 10) {
     String result = "<!DOCTYPE html><html><title>Reload page</title><meta http-equiv='refresh' content='";
     result = result + sec;
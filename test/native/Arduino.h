@@ -0,0 +1,122 @@
+#ifndef Arduino_h
+#define Arduino_h
+
+// Just enough of the ESP8266 Arduino core to run the libraries on the host
+// in the native environment, see platformio.ini
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <thread>
+#if defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+#endif
+
+#define HIGH 0x1
+#define LOW  0x0
+#define INPUT  0x00
+#define OUTPUT 0x01
+
+// Macros of the core, so that the libraries see the same names
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+#define radians(deg) ((deg)*DEG_TO_RAD)
+#define degrees(rad) ((rad)*RAD_TO_DEG)
+#define sq(x) ((x)*(x))
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+#define pgm_read_word(addr) (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define memcpy_P memcpy
+#define F(string) (string)
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+inline unsigned long micros(void)
+{
+  static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline unsigned long millis(void)
+{
+  return micros() / 1000;
+}
+
+inline void delay(unsigned long ms)
+{
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+inline void delayMicroseconds(unsigned int us)
+{
+  std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+inline void yield(void)
+{
+}
+
+inline void pinMode(uint8_t pin, uint8_t mode)
+{
+  (void)pin;
+  (void)mode;
+}
+
+inline void digitalWrite(uint8_t pin, uint8_t value)
+{
+  (void)pin;
+  (void)value;
+}
+
+inline int digitalRead(uint8_t pin)
+{
+  (void)pin;
+  return HIGH;
+}
+
+class EspClass
+{
+
+public:
+  // The time stamp counter of the host stands in for the CPU cycle counter
+  uint32_t getCycleCount(void) {
+    #if defined(__x86_64__) || defined(__i386__)
+    return (uint32_t)__rdtsc();
+    #else
+    return (uint32_t)(micros() * 80);
+    #endif
+  }
+
+  // Rate of getCycleCount(), measured once against the steady clock. The
+  // core returns an uint8_t, the time stamp counter runs faster.
+  uint32_t getCpuFreqMHz(void) {
+    static uint32_t mhz = 0;
+    if (mhz == 0) {
+      unsigned long start = micros();
+      uint32_t cycles = getCycleCount();
+      delay(20);
+      mhz = (getCycleCount() - cycles) / (micros() - start);
+    }
+    return mhz;
+  }
+
+  uint32_t getFreeHeap(void) {
+    return 0;
+  }
+
+};
+
+static EspClass ESP __attribute__((unused));
+
+#endif
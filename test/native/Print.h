@@ -0,0 +1,33 @@
+#ifndef Print_h
+#define Print_h
+
+#include <Arduino.h>
+
+// Base class of U8X8, output goes nowhere on the host
+class Print
+{
+
+public:
+  virtual ~Print(void) {}
+
+  virtual size_t write(uint8_t c) = 0;
+
+  virtual size_t write(const uint8_t *buffer, size_t size) {
+    size_t n = 0;
+    while (size--) {
+      n += write(*buffer++);
+    }
+    return n;
+  }
+
+  size_t write(const char *s) {
+    return write((const uint8_t *)s, strlen(s));
+  }
+
+  size_t print(const char *s) {
+    return write(s);
+  }
+
+};
+
+#endif
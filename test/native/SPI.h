@@ -0,0 +1,39 @@
+#ifndef SPI_h
+#define SPI_h
+
+#include <Arduino.h>
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x01
+#define SPI_MODE2 0x02
+#define SPI_MODE3 0x03
+#define LSBFIRST 0
+#define MSBFIRST 1
+
+class SPISettings
+{
+
+public:
+  SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode) { (void)clock; (void)bitOrder; (void)dataMode; }
+
+};
+
+// No SPI on the host, only here so that U8x8lib.cpp compiles
+class SPIClass
+{
+
+public:
+  void begin(void) {}
+  void end(void) {}
+  void beginTransaction(SPISettings settings) { (void)settings; }
+  void endTransaction(void) {}
+  uint8_t transfer(uint8_t data) { return data; }
+  void setBitOrder(uint8_t bitOrder) { (void)bitOrder; }
+  void setDataMode(uint8_t dataMode) { (void)dataMode; }
+  void setClockDivider(uint8_t divider) { (void)divider; }
+
+};
+
+static SPIClass SPI __attribute__((unused));
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef Wire_h
+#define Wire_h
+
+#include <Arduino.h>
+
+// Size of the ESP8266 Wire buffer
+#define BUFFER_LENGTH 128
+
+// No I2C on the host, the tests install their own u8x8 byte callbacks
+class TwoWire
+{
+
+public:
+  void begin(void) {}
+  void begin(int sda, int scl) { (void)sda; (void)scl; }
+  void setClock(uint32_t clock) { (void)clock; }
+  void beginTransmission(uint8_t address) { (void)address; }
+  uint8_t endTransmission(bool stop = true) { (void)stop; return 0; }
+  size_t write(uint8_t data) { (void)data; return 1; }
+  size_t write(const uint8_t *data, size_t size) { (void)data; return size; }
+  uint8_t requestFrom(uint8_t address, uint8_t size) { (void)address; (void)size; return 0; }
+  int available(void) { return 0; }
+  int read(void) { return -1; }
+
+};
+
+static TwoWire Wire __attribute__((unused));
+
+#endif
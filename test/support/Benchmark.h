@@ -0,0 +1,57 @@
+#ifndef Benchmark_h
+#define Benchmark_h
+
+#include <Arduino.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <unity.h>
+
+// Benchmarks run in both environments: on the d1_mini the cycle counter
+// of the ESP8266, on the host the time stamp counter. Results are printed
+// with the test output, only ratios are asserted.
+
+#define BENCHMARK_RUNS 5
+
+// Results are written here, so the compiler cannot drop the measured code
+static volatile uint32_t benchmarkSink __attribute__((unused));
+
+// Cycles of the fastest of BENCHMARK_RUNS runs of fn
+template <class Function>
+uint32_t benchmarkCycles(Function fn)
+{
+  uint32_t best = 0xFFFFFFFF;
+
+  for (uint8_t run = 0; run < BENCHMARK_RUNS; run++) {
+    uint32_t start = ESP.getCycleCount();
+    fn();
+    uint32_t cycles = ESP.getCycleCount() - start;
+    if (cycles < best) {
+      best = cycles;
+    }
+    yield();
+  }
+  return best;
+}
+
+// Operations per second for count operations that took cycles
+static uint32_t benchmarkPerSecond(uint32_t count, uint32_t cycles) __attribute__((unused));
+
+static uint32_t benchmarkPerSecond(uint32_t count, uint32_t cycles)
+{
+  return cycles > 0 ? (uint64_t)count * ESP.getCpuFreqMHz() * 1000000 / cycles : 0;
+}
+
+static void benchmarkReport(const char *format, ...) __attribute__((format(printf, 1, 2), unused));
+
+static void benchmarkReport(const char *format, ...)
+{
+  char message[128];
+  va_list args;
+
+  va_start(args, format);
+  vsnprintf(message, sizeof(message), format, args);
+  va_end(args);
+  TEST_MESSAGE(message);
+}
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef TestBus_h
+#define TestBus_h
+
+#include <Arduino.h>
+#include <U8g2lib.h>
+
+// Controller bytes kept by the log, a full frame with its page commands fits
+#define TEST_BUS_LOG_SIZE 1536
+
+// Data bytes are logged with this bit set, command bytes without
+#define TEST_BUS_DATA_BIT 0x100
+
+// Byte callback in place of the I2C bus. Counts transactions and bytes and
+// logs what reaches the controller: the control byte of a transaction
+// decides whether the following bytes are commands or data.
+class TestBus
+{
+
+public:
+  static void reset(void) {
+    state().transactions = 0;
+    state().bytes = 0;
+    state().dataBytes = 0;
+    state().largestTransaction = 0;
+    state().logLength = 0;
+  }
+
+  static uint16_t transactions(void) { return state().transactions; }
+  static uint32_t bytes(void) { return state().bytes; }
+  static uint32_t dataBytes(void) { return state().dataBytes; }
+  // Control byte included
+  static uint16_t largestTransaction(void) { return state().largestTransaction; }
+  static uint16_t logLength(void) { return state().logLength; }
+  static const uint16_t *log(void) { return state().log; }
+
+  static uint8_t byteCallback(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr) {
+    State &s = state();
+    (void)u8x8;
+
+    switch (msg) {
+      case U8X8_MSG_BYTE_START_TRANSFER:
+        s.transactions++;
+        s.position = 0;
+        break;
+
+      case U8X8_MSG_BYTE_SEND:
+        for (uint8_t i = 0; i < arg_int; i++) {
+          uint8_t b = ((const uint8_t *)arg_ptr)[i];
+          if (s.position == 0) {
+            s.data = b == 0x40;
+          } else {
+            if (s.data) {
+              s.dataBytes++;
+            }
+            if (s.logLength < TEST_BUS_LOG_SIZE) {
+              s.log[s.logLength++] = s.data ? (TEST_BUS_DATA_BIT | b) : b;
+            }
+          }
+          s.position++;
+          s.bytes++;
+        }
+        if (s.position > s.largestTransaction) {
+          s.largestTransaction = s.position;
+        }
+        break;
+    }
+    return 1;
+  }
+
+  static uint8_t gpioCallback(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr) {
+    (void)u8x8;
+    (void)msg;
+    (void)arg_int;
+    (void)arg_ptr;
+    return 1;
+  }
+
+protected:
+  struct State {
+    uint16_t transactions;
+    uint32_t bytes;
+    uint32_t dataBytes;
+    uint16_t largestTransaction;
+    uint16_t position;
+    bool data;
+    uint16_t logLength;
+    uint16_t log[TEST_BUS_LOG_SIZE];
+  };
+
+  static State &state(void) {
+    static State s;
+    return s;
+  }
+
+};
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef TestFonts_h
+#define TestFonts_h
+
+#include <Arduino.h>
+#include <U8g2lib.h>
+
+// The fonts main.cpp uses with text the clock draws in them, see
+// custom_font_subsets in platformio.ini
+struct TestFont {
+  const char *name;
+  const uint8_t *font;
+  const char *text;
+};
+
+#define TEST_FONTS 10
+
+static const TestFont testFonts[TEST_FONTS] __attribute__((unused)) = {
+  { "7x14B_tf",                u8g2_font_7x14B_tf,                   "Jan 05 2019, SAT" },
+  { "logisoso22_tn",           u8g2_font_logisoso22_tn,              "10:08" },
+  { "logisoso16_tf",           u8g2_font_logisoso16_tf,              "0123456789" },
+  { "profont12_tn",            u8g2_font_profont12_tn,               "0123456789" },
+  { "haxrcorp4089_tn",         u8g2_font_haxrcorp4089_tn,            "0123456789" },
+  { "glasstown_nbp_tn",        u8g2_font_glasstown_nbp_tn,           "0123456789" },
+  { "smart_patrol_nbp_tf",     u8g2_font_smart_patrol_nbp_tf,        "Demo" },
+  { "open_iconic_www_1x",      u8g2_font_open_iconic_www_1x_t,       "EHNOQS" },
+  { "open_iconic_www_2x",      u8g2_font_open_iconic_www_2x_t,       "C" },
+  { "open_iconic_embedded_2x", u8g2_font_open_iconic_embedded_2x_t,  "N" }
+};
+
+#endif
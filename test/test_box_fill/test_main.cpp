@@ -0,0 +1,186 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <U8g2lib.h>
+#include <BoxFill.h>
+#include "../support/Benchmark.h"
+#include "../support/TestBus.h"
+
+#define PAGE_BUFFER_TILES 2
+
+static u8g2_t reference;
+static u8g2_t filled;
+static uint8_t referenceBuffer[8 * 128];
+static uint8_t filledBuffer[8 * 128];
+static uint8_t referencePage[PAGE_BUFFER_TILES * 128];
+static uint8_t filledPage[PAGE_BUFFER_TILES * 128];
+static BoxFill boxFill;
+static uint32_t seed;
+
+static uint16_t nextRandom(uint16_t limit)
+{
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 16) % limit;
+}
+
+static void setColor(uint8_t color)
+{
+  u8g2_SetDrawColor(&reference, color);
+  u8g2_SetDrawColor(&filled, color);
+}
+
+// A random box, horizontal line or frame drawn by u8g2 and by BoxFill.
+// Some reach off the screen, none wraps around.
+static void drawBoth(void)
+{
+  u8g2_uint_t x = nextRandom(10) < 7 ? nextRandom(140) : nextRandom(256);
+  u8g2_uint_t y = nextRandom(10) < 7 ? nextRandom(70) : nextRandom(128);
+  u8g2_uint_t w = nextRandom(3) > 0 ? nextRandom(70) : nextRandom(256);
+  u8g2_uint_t h = nextRandom(3) > 0 ? nextRandom(40) : nextRandom(256);
+
+  if (x + w > 255) {
+    w = 255 - x;
+  }
+  if (y + h > 255) {
+    h = 255 - y;
+  }
+
+  switch (nextRandom(3)) {
+    case 0:
+      u8g2_DrawBox(&reference, x, y, w, h);
+      boxFill.drawBox(&filled, x, y, w, h);
+      break;
+    case 1:
+      u8g2_DrawHLine(&reference, x, y, w);
+      boxFill.drawHLine(&filled, x, y, w);
+      break;
+    default:
+      u8g2_DrawFrame(&reference, x, y, w, h);
+      boxFill.drawFrame(&filled, x, y, w, h);
+      break;
+  }
+}
+
+void setUp(void)
+{
+  u8g2_Setup_ssd1306_i2c_128x64_noname_f(&reference, U8G2_R0, TestBus::byteCallback, TestBus::gpioCallback);
+  u8g2_Setup_ssd1306_i2c_128x64_noname_f(&filled, U8G2_R0, TestBus::byteCallback, TestBus::gpioCallback);
+  // The full buffer setups share one static buffer, give each its own
+  u8g2_SetupBuffer(&reference, referenceBuffer, 8, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+  u8g2_SetupBuffer(&filled, filledBuffer, 8, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+  u8g2_ClearBuffer(&reference);
+  u8g2_ClearBuffer(&filled);
+  seed = 3;
+}
+
+void tearDown(void)
+{
+}
+
+// Random boxes in all three colors, some inside a clip window
+void test_full_buffer_matches_u8g2(void)
+{
+  for (uint16_t i = 0; i < 20000; i++) {
+    setColor(nextRandom(3));
+    if (nextRandom(5) == 0) {
+      u8g2_uint_t x0 = nextRandom(128);
+      u8g2_uint_t y0 = nextRandom(64);
+      u8g2_uint_t x1 = x0 + 1 + nextRandom(100);
+      u8g2_uint_t y1 = y0 + 1 + nextRandom(60);
+      u8g2_SetClipWindow(&reference, x0, y0, x1, y1);
+      u8g2_SetClipWindow(&filled, x0, y0, x1, y1);
+    } else {
+      u8g2_SetMaxClipWindow(&reference);
+      u8g2_SetMaxClipWindow(&filled);
+    }
+
+    drawBoth();
+    TEST_ASSERT_EQUAL_MEMORY(u8g2_GetBufferPtr(&reference), u8g2_GetBufferPtr(&filled), 1024);
+
+    if (i % 32 == 0) {
+      u8g2_ClearBuffer(&reference);
+      u8g2_ClearBuffer(&filled);
+      yield();
+    }
+  }
+}
+
+// Boxes cut off at the edges of every page of a two page buffer
+void test_page_buffer_matches_u8g2(void)
+{
+  u8g2_SetupBuffer(&reference, referencePage, PAGE_BUFFER_TILES, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+  u8g2_SetupBuffer(&filled, filledPage, PAGE_BUFFER_TILES, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+
+  for (uint16_t i = 0; i < 5000; i++) {
+    setColor(nextRandom(3));
+    uint32_t drawSeed = seed;
+
+    for (uint8_t row = 0; row < 8; row += PAGE_BUFFER_TILES) {
+      u8g2_SetBufferCurrTileRow(&reference, row);
+      u8g2_SetBufferCurrTileRow(&filled, row);
+      memset(referencePage, 0x5A, sizeof(referencePage));
+      memset(filledPage, 0x5A, sizeof(filledPage));
+      seed = drawSeed;
+      drawBoth();
+      TEST_ASSERT_EQUAL_MEMORY(referencePage, filledPage, sizeof(referencePage));
+    }
+    if (i % 256 == 0) {
+      yield();
+    }
+  }
+}
+
+// Boxes per second for a 100x40 box like the central block of the faces,
+// at every row offset within a page. Each box writes 500 or 600 bytes.
+void test_boxes_per_second(void)
+{
+  static const char *colors[3] = { "clear", "set", "invert" };
+
+  for (uint8_t color = 0; color < 3; color++) {
+    setColor(color);
+
+    uint32_t u8g2Cycles = benchmarkCycles([&]() {
+      for (uint8_t y = 8; y < 16; y++) {
+        u8g2_DrawBox(&reference, 3, y, 100, 40);
+      }
+    });
+    uint32_t boxFillCycles = benchmarkCycles([&]() {
+      for (uint8_t y = 8; y < 16; y++) {
+        boxFill.drawBox(&filled, 3, y, 100, 40);
+      }
+    });
+
+    benchmarkReport("%s: u8g2 %u cycles per box, %u boxes/s", colors[color], (unsigned)(u8g2Cycles / 8), (unsigned)benchmarkPerSecond(8, u8g2Cycles));
+    benchmarkReport("%s: BoxFill %u cycles per box, %u boxes/s", colors[color], (unsigned)(boxFillCycles / 8), (unsigned)benchmarkPerSecond(8, boxFillCycles));
+    TEST_ASSERT_LESS_THAN(u8g2Cycles, boxFillCycles);
+  }
+}
+
+void runTests(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_full_buffer_matches_u8g2);
+  RUN_TEST(test_page_buffer_matches_u8g2);
+  RUN_TEST(test_boxes_per_second);
+  UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+  // Time for the serial monitor to connect
+  delay(2000);
+  runTests();
+}
+
+void loop()
+{
+}
+#else
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  runTests();
+  return 0;
+}
+#endif
@@ -0,0 +1,164 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <U8g2lib.h>
+#include <DisplayBus.h>
+#include "../support/Benchmark.h"
+#include "../support/TestBus.h"
+
+// Bits per byte on I2C plus the acknowledge bit
+#define I2C_BITS_PER_BYTE 9
+#define I2C_DISPLAY_CLOCK 400000
+
+#define BUFFER_MODES 3
+
+typedef void (*SetupFunction)(u8g2_t *u8g2, const u8g2_cb_t *rotation, u8x8_msg_cb byte_cb, u8x8_msg_cb gpio_and_delay_cb);
+
+struct BufferMode {
+  const char *name;
+  SetupFunction setup;
+};
+
+static const BufferMode modes[BUFFER_MODES] = {
+  { "F", u8g2_Setup_ssd1306_i2c_128x64_noname_f },
+  { "2", u8g2_Setup_ssd1306_i2c_128x64_noname_2 },
+  { "1", u8g2_Setup_ssd1306_i2c_128x64_noname_1 }
+};
+
+struct ModeResult {
+  uint16_t bufferBytes;
+  uint32_t renderCycles;
+  uint16_t transactions;
+  uint32_t busBytes;
+  uint16_t logLength;
+  uint16_t log[TEST_BUS_LOG_SIZE];
+};
+
+static ModeResult results[BUFFER_MODES];
+
+// Same test as pageIntersects() in main.cpp
+static bool pageIntersects(u8g2_t *u8g2, int16_t top, int16_t bottom)
+{
+  return bottom >= u8g2->pixel_curr_row && top < u8g2->pixel_curr_row + u8g2->pixel_buf_height;
+}
+
+// The elements of face 3: date bar, digital time and the dial on the right
+static void drawFace(u8g2_t *u8g2)
+{
+  const uint8_t centerX = 104;
+  const uint8_t centerY = 39;
+  const uint8_t radius = 23;
+
+  if (pageIntersects(u8g2, 0, 13)) {
+    u8g2_SetFont(u8g2, u8g2_font_7x14B_tf);
+    u8g2_DrawStr(u8g2, 0, 10, "Jan 05 2019, SAT");
+  }
+
+  if (pageIntersects(u8g2, 16, 38)) {
+    u8g2_SetFont(u8g2, u8g2_font_logisoso22_tn);
+    u8g2_DrawStr(u8g2, 2, 38, "10:08");
+  }
+
+  if (pageIntersects(u8g2, centerY - radius, centerY + radius)) {
+    u8g2_DrawCircle(u8g2, centerX, centerY, radius, U8G2_DRAW_ALL);
+    u8g2_DrawCircle(u8g2, centerX, centerY, radius - 1, U8G2_DRAW_ALL);
+    u8g2_DrawDisc(u8g2, centerX, centerY, 2, U8G2_DRAW_ALL);
+    for (uint8_t mark = 0; mark < 12; mark++) {
+      double angle = (mark * 30 + 270) * PI / 180.0;
+      u8g2_DrawLine(u8g2, centerX + lround((radius - 1) * cos(angle)), centerY + lround((radius - 1) * sin(angle)),
+        centerX + lround((radius - 5) * cos(angle)), centerY + lround((radius - 5) * sin(angle)));
+    }
+    // Minute and hour hand
+    u8g2_DrawLine(u8g2, 104, 21, 107, 33);
+    u8g2_DrawLine(u8g2, 107, 33, 104, 43);
+    u8g2_DrawLine(u8g2, 104, 43, 101, 33);
+    u8g2_DrawLine(u8g2, 101, 33, 104, 21);
+    u8g2_DrawLine(u8g2, 114, 33, 103, 37);
+    u8g2_DrawLine(u8g2, 103, 37, 100, 41);
+    u8g2_DrawLine(u8g2, 100, 41, 108, 40);
+    u8g2_DrawLine(u8g2, 108, 40, 114, 33);
+  }
+}
+
+static void renderMode(const BufferMode &mode, ModeResult &result)
+{
+  u8g2_t u8g2;
+
+  mode.setup(&u8g2, U8G2_R0, TestBus::byteCallback, TestBus::gpioCallback);
+  DisplayBus::begin(u8g2_GetU8x8(&u8g2));
+  u8g2_InitDisplay(&u8g2);
+  u8g2_SetPowerSave(&u8g2, 0);
+  u8g2_SetFontMode(&u8g2, 1);
+
+  result.bufferBytes = 8 * u8g2_GetBufferTileHeight(&u8g2) * u8g2_GetBufferTileWidth(&u8g2);
+  result.renderCycles = benchmarkCycles([&]() {
+    TestBus::reset();
+    u8g2_FirstPage(&u8g2);
+    do {
+      drawFace(&u8g2);
+    } while (u8g2_NextPage(&u8g2));
+  });
+  result.transactions = TestBus::transactions();
+  result.busBytes = TestBus::bytes();
+  result.logLength = TestBus::logLength();
+  memcpy(result.log, TestBus::log(), result.logLength * sizeof(uint16_t));
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_compare_buffer_modes(void)
+{
+  for (uint8_t i = 0; i < BUFFER_MODES; i++) {
+    renderMode(modes[i], results[i]);
+
+    // Address byte and start/stop take about one byte time per transaction
+    uint32_t transferMicros = (uint32_t)((uint64_t)(results[i].busBytes + results[i].transactions) * I2C_BITS_PER_BYTE * 1000000 / I2C_DISPLAY_CLOCK);
+    benchmarkReport("%s: %u bytes buffer, %u cycles render, %u transactions, %u bytes, ~%u us transfer at 400 kHz",
+      modes[i].name, (unsigned)results[i].bufferBytes, (unsigned)results[i].renderCycles,
+      (unsigned)results[i].transactions, (unsigned)results[i].busBytes, (unsigned)transferMicros);
+  }
+
+  TEST_ASSERT_EQUAL_UINT16(1024, results[0].bufferBytes);
+  TEST_ASSERT_EQUAL_UINT16(256, results[1].bufferBytes);
+  TEST_ASSERT_EQUAL_UINT16(128, results[2].bufferBytes);
+
+  // Every mode sends the same frame in the same transactions
+  for (uint8_t i = 1; i < BUFFER_MODES; i++) {
+    TEST_ASSERT_EQUAL_UINT16(results[0].transactions, results[i].transactions);
+    TEST_ASSERT_EQUAL_UINT16(results[0].logLength, results[i].logLength);
+    TEST_ASSERT_EQUAL_MEMORY(results[0].log, results[i].log, results[0].logLength * sizeof(uint16_t));
+  }
+}
+
+void runTests(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_compare_buffer_modes);
+  UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+  // Time for the serial monitor to connect
+  delay(2000);
+  runTests();
+}
+
+void loop()
+{
+}
+#else
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  runTests();
+  return 0;
+}
+#endif
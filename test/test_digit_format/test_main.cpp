@@ -0,0 +1,121 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <DigitFormat.h>
+#include "../support/Benchmark.h"
+
+static const char *monthNames[12] = { "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+static const char *dayNames[7] = { "SUN", "MON", "TUE", "WED", "THU", "FRI", "SAT" };
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_number_matches_sprintf(void)
+{
+  for (uint16_t value = 0; value < 256; value++) {
+    char expected[8];
+    char actual[DIGIT_FORMAT_NUMBER_SIZE];
+    sprintf(expected, "%d", value);
+    TEST_ASSERT_EQUAL_STRING(expected, DigitFormat::number(actual, value));
+  }
+}
+
+void test_two_digits_match_sprintf(void)
+{
+  for (uint8_t value = 0; value < 100; value++) {
+    char expected[8];
+    char actual[DIGIT_FORMAT_TWO_SIZE];
+    sprintf(expected, "%02d", value);
+    TEST_ASSERT_EQUAL_STRING(expected, DigitFormat::twoDigits(actual, value));
+  }
+}
+
+void test_time_matches_sprintf(void)
+{
+  for (uint8_t h = 0; h < 24; h++) {
+    for (uint8_t m = 0; m < 60; m++) {
+      char expected[16];
+      char actual[DIGIT_FORMAT_TIME_SIZE];
+      sprintf(expected, "%02d:%02d", h, m);
+      TEST_ASSERT_EQUAL_STRING(expected, DigitFormat::time(actual, h, m));
+    }
+  }
+}
+
+void test_date_matches_sprintf(void)
+{
+  for (uint16_t year = 1970; year < 2226; year++) {
+    for (uint8_t day = 1; day <= 31; day++) {
+      const char *month = monthNames[(year + day) % 12];
+      const char *weekday = dayNames[(year + day) % 7];
+      char expected[32];
+      char actual[DIGIT_FORMAT_DATE_SIZE];
+      sprintf(expected, "%s %02d %04d, %s", month, day, year, weekday);
+      TEST_ASSERT_EQUAL_STRING(expected, DigitFormat::date(actual, month, day, year, weekday));
+    }
+  }
+}
+
+// The strings face 1 formats every frame: date line, time and seconds
+void test_cycles_per_frame(void)
+{
+  char date[32];
+  char time[16];
+  char second[8];
+
+  uint32_t sprintfCycles = benchmarkCycles([&]() {
+    for (uint8_t s = 0; s < 60; s++) {
+      sprintf(date, "%s %02d %04d, %s", monthNames[s % 12], s % 31 + 1, 2019, dayNames[s % 7]);
+      sprintf(time, "%02d:%02d", s % 24, s);
+      sprintf(second, "%02d", s);
+      benchmarkSink = date[5] + time[4] + second[1];
+    }
+  }) / 60;
+  uint32_t digitCycles = benchmarkCycles([&]() {
+    for (uint8_t s = 0; s < 60; s++) {
+      DigitFormat::date(date, monthNames[s % 12], s % 31 + 1, 2019, dayNames[s % 7]);
+      DigitFormat::time(time, s % 24, s);
+      DigitFormat::twoDigits(second, s);
+      benchmarkSink = date[5] + time[4] + second[1];
+    }
+  }) / 60;
+
+  benchmarkReport("%u cycles per frame with sprintf, %u with DigitFormat", (unsigned)sprintfCycles, (unsigned)digitCycles);
+  TEST_ASSERT_LESS_THAN(sprintfCycles, digitCycles);
+}
+
+void runTests(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_number_matches_sprintf);
+  RUN_TEST(test_two_digits_match_sprintf);
+  RUN_TEST(test_time_matches_sprintf);
+  RUN_TEST(test_date_matches_sprintf);
+  RUN_TEST(test_cycles_per_frame);
+  UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+  // Time for the serial monitor to connect
+  delay(2000);
+  runTests();
+}
+
+void loop()
+{
+}
+#else
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  runTests();
+  return 0;
+}
+#endif
@@ -0,0 +1,118 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <U8g2lib.h>
+#include <DisplayBus.h>
+#include "../support/TestBus.h"
+
+struct BusRun {
+  uint16_t initTransactions;
+  uint32_t initBytes;
+  uint16_t frameTransactions;
+  uint32_t frameBytes;
+  uint16_t largestTransaction;
+  uint16_t logLength;
+  uint16_t log[TEST_BUS_LOG_SIZE];
+};
+
+static BusRun stock;
+static BusRun batched;
+
+// Init sequence and one full frame, the way the clock sets up the display
+static void run(bool useDisplayBus, BusRun &result)
+{
+  u8g2_t u8g2;
+
+  u8g2_Setup_ssd1306_i2c_128x64_noname_f(&u8g2, U8G2_R0, TestBus::byteCallback, TestBus::gpioCallback);
+  if (useDisplayBus) {
+    DisplayBus::begin(u8g2_GetU8x8(&u8g2));
+  }
+
+  TestBus::reset();
+  u8g2_InitDisplay(&u8g2);
+  u8g2_SetPowerSave(&u8g2, 0);
+  result.initTransactions = TestBus::transactions();
+  result.initBytes = TestBus::bytes();
+  uint16_t initLength = TestBus::logLength();
+  memcpy(result.log, TestBus::log(), initLength * sizeof(uint16_t));
+
+  TestBus::reset();
+  u8g2_ClearBuffer(&u8g2);
+  u8g2_DrawBox(&u8g2, 3, 5, 50, 40);
+  u8g2_SendBuffer(&u8g2);
+  result.frameTransactions = TestBus::transactions();
+  result.frameBytes = TestBus::bytes();
+  result.largestTransaction = TestBus::largestTransaction();
+  TEST_ASSERT_TRUE(initLength + TestBus::logLength() <= TEST_BUS_LOG_SIZE);
+  memcpy(result.log + initLength, TestBus::log(), TestBus::logLength() * sizeof(uint16_t));
+  result.logLength = initLength + TestBus::logLength();
+}
+
+// Both runs are repeated for every test, so each test sees fresh logs
+void setUp(void)
+{
+  run(false, stock);
+  run(true, batched);
+}
+
+void tearDown(void)
+{
+}
+
+void test_frame_transactions(void)
+{
+  // Page commands and six 24 byte data pieces per page
+  TEST_ASSERT_EQUAL_UINT16(64, stock.frameTransactions);
+  TEST_ASSERT_EQUAL_UINT32(1120, stock.frameBytes);
+  // One command and two data transactions per page
+  TEST_ASSERT_EQUAL_UINT16(24, batched.frameTransactions);
+  TEST_ASSERT_EQUAL_UINT32(1080, batched.frameBytes);
+}
+
+void test_init_transactions(void)
+{
+  TEST_ASSERT_EQUAL_UINT16(17, stock.initTransactions);
+  TEST_ASSERT_EQUAL_UINT16(2, batched.initTransactions);
+  TEST_ASSERT_LESS_THAN(stock.initBytes, batched.initBytes);
+}
+
+void test_controller_sees_the_same_bytes(void)
+{
+  TEST_ASSERT_EQUAL_UINT16(stock.logLength, batched.logLength);
+  TEST_ASSERT_EQUAL_MEMORY(stock.log, batched.log, stock.logLength * sizeof(uint16_t));
+}
+
+void test_transactions_fit_the_wire_buffer(void)
+{
+  TEST_ASSERT_TRUE(batched.largestTransaction <= DISPLAY_BUS_TRANSFER_SIZE);
+}
+
+void runTests(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_frame_transactions);
+  RUN_TEST(test_init_transactions);
+  RUN_TEST(test_controller_sees_the_same_bytes);
+  RUN_TEST(test_transactions_fit_the_wire_buffer);
+  UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+  // Time for the serial monitor to connect
+  delay(2000);
+  runTests();
+}
+
+void loop()
+{
+}
+#else
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  runTests();
+  return 0;
+}
+#endif
@@ -0,0 +1,394 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <U8g2lib.h>
+#include <DisplayList.h>
+#include "../support/TestBus.h"
+#include "../support/TestFonts.h"
+
+#define PAGE_BUFFER_TILES 2
+
+static u8g2_t reference;
+static u8g2_t paged;
+static u8g2_t *target;
+static uint8_t page[PAGE_BUFFER_TILES * 128];
+static DisplayList displayList;
+static uint32_t seed;
+
+static uint16_t nextRandom(uint16_t limit)
+{
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 16) % limit;
+}
+
+// The draw calls main.cpp makes for a command, with plain u8g2 calls for
+// rings and quads
+static void execute(const DisplayCommand &command)
+{
+  const uint8_t *a = command.args;
+
+  switch (command.type) {
+    case DISPLAY_COLOR:
+      u8g2_SetDrawColor(target, a[0]);
+      break;
+    case DISPLAY_FONT:
+      u8g2_SetFont(target, command.font);
+      break;
+    case DISPLAY_FONT_MODE:
+      u8g2_SetFontMode(target, a[0]);
+      break;
+    case DISPLAY_FONT_DIRECTION:
+      u8g2_SetFontDirection(target, a[0]);
+      break;
+    case DISPLAY_LINE:
+      u8g2_DrawLine(target, a[0], a[1], a[2], a[3]);
+      break;
+    case DISPLAY_BOX:
+      u8g2_DrawBox(target, a[0], a[1], a[2], a[3]);
+      break;
+    case DISPLAY_HLINE:
+      u8g2_DrawHLine(target, a[0], a[1], a[2]);
+      break;
+    case DISPLAY_FRAME:
+      u8g2_DrawFrame(target, a[0], a[1], a[2], a[3]);
+      break;
+    case DISPLAY_RBOX:
+      u8g2_DrawRBox(target, a[0], a[1], a[2], a[3], a[4]);
+      break;
+    case DISPLAY_RFRAME:
+      u8g2_DrawRFrame(target, a[0], a[1], a[2], a[3], a[4]);
+      break;
+    case DISPLAY_RING:
+      for (uint8_t r = a[2]; r <= a[3]; r++) {
+        u8g2_DrawCircle(target, a[0], a[1], r, U8G2_DRAW_ALL);
+      }
+      break;
+    case DISPLAY_QUAD:
+      for (uint8_t i = 0; i < 4; i++) {
+        uint8_t j = (i + 1) & 3;
+        u8g2_DrawLine(target, a[i], a[4 + i], a[j], a[4 + j]);
+      }
+      break;
+    case DISPLAY_STR:
+      u8g2_DrawStr(target, a[0], a[1], command.str);
+      break;
+    case DISPLAY_GLYPH:
+      u8g2_DrawGlyph(target, a[0], a[1], command.encoding);
+      break;
+    default:
+      break;
+  }
+}
+
+// Adds a command like the drawing calls of main.cpp do while recording.
+// State changes are applied to the page buffer at once, so text rows come
+// from the current font.
+static void record(const DisplayCommand &command)
+{
+  const uint8_t *a = command.args;
+
+  switch (command.type) {
+    case DISPLAY_COLOR:
+      displayList.addColor(a[0]);
+      break;
+    case DISPLAY_FONT:
+      displayList.addFont(command.font);
+      break;
+    case DISPLAY_FONT_MODE:
+      displayList.addFontMode(a[0]);
+      break;
+    case DISPLAY_FONT_DIRECTION:
+      displayList.addFontDirection(a[0]);
+      break;
+    case DISPLAY_LINE:
+      displayList.addLine(a[0], a[1], a[2], a[3]);
+      break;
+    case DISPLAY_BOX:
+      displayList.addBox(a[0], a[1], a[2], a[3]);
+      break;
+    case DISPLAY_HLINE:
+      displayList.addHLine(a[0], a[1], a[2]);
+      break;
+    case DISPLAY_FRAME:
+      displayList.addFrame(a[0], a[1], a[2], a[3]);
+      break;
+    case DISPLAY_RBOX:
+      displayList.addRBox(a[0], a[1], a[2], a[3], a[4]);
+      break;
+    case DISPLAY_RFRAME:
+      displayList.addRFrame(a[0], a[1], a[2], a[3], a[4]);
+      break;
+    case DISPLAY_RING:
+      displayList.addRing(a[0], a[1], a[2], a[3]);
+      break;
+    case DISPLAY_QUAD:
+      displayList.addQuad(a, a + 4);
+      break;
+    case DISPLAY_STR:
+      displayList.addStr(a[0], a[1], command.str);
+      break;
+    case DISPLAY_GLYPH:
+      displayList.addGlyph(a[0], a[1], command.encoding);
+      break;
+    default:
+      break;
+  }
+  if (command.type < DISPLAY_LINE) {
+    target = &paged;
+    execute(command);
+  }
+}
+
+// A random command of the given type. Some shapes reach off the screen,
+// long slanted lines wrap around the 8 bit coordinates.
+static DisplayCommand randomCommand(uint8_t type, uint8_t font)
+{
+  DisplayCommand command;
+  uint8_t *a = command.args;
+  const char *text = testFonts[font].text;
+
+  memset(&command, 0, sizeof(command));
+  command.type = type;
+  for (uint8_t i = 0; i < DISPLAY_LIST_MAX_ARGS; i++) {
+    a[i] = nextRandom(i & 1 ? 80 : 140);
+  }
+
+  switch (type) {
+    case DISPLAY_COLOR:
+      a[0] = nextRandom(3);
+      break;
+    case DISPLAY_FONT:
+      command.font = testFonts[font].font;
+      break;
+    case DISPLAY_FONT_MODE:
+      a[0] = nextRandom(2);
+      break;
+    case DISPLAY_FONT_DIRECTION:
+      a[0] = nextRandom(4);
+      break;
+    case DISPLAY_LINE:
+      if (nextRandom(8) == 0) {
+        a[2] = nextRandom(256);
+        a[3] = nextRandom(256);
+      }
+      break;
+    case DISPLAY_BOX:
+    case DISPLAY_FRAME:
+      a[0] = nextRandom(100);
+      a[2] = 1 + nextRandom(40);
+      a[3] = 1 + nextRandom(30);
+      break;
+    case DISPLAY_HLINE:
+      a[0] = nextRandom(100);
+      a[2] = 1 + nextRandom(60);
+      break;
+    case DISPLAY_RBOX:
+    case DISPLAY_RFRAME:
+      a[0] = nextRandom(80);
+      a[1] = nextRandom(50);
+      a[2] = 8 + nextRandom(40);
+      a[3] = 8 + nextRandom(30);
+      a[4] = 3;
+      break;
+    case DISPLAY_RING:
+      a[0] = 30 + nextRandom(60);
+      a[1] = nextRandom(64);
+      a[3] = nextRandom(25);
+      a[2] = nextRandom(a[3] + 1);
+      break;
+    case DISPLAY_QUAD:
+      for (uint8_t i = 0; i < 4; i++) {
+        a[i] %= 128;
+      }
+      break;
+    case DISPLAY_STR:
+      command.str = text + nextRandom(strlen(text));
+      break;
+    case DISPLAY_GLYPH:
+      command.encoding = (uint8_t)text[nextRandom(strlen(text))];
+      break;
+    default:
+      break;
+  }
+  return command;
+}
+
+// Font position, font, mode and color the drawing code finds
+static void resetState(uint8_t position)
+{
+  static void (*const positions[3])(u8g2_t *) = { u8g2_SetFontPosBaseline, u8g2_SetFontPosBottom, u8g2_SetFontPosTop };
+  u8g2_t *both[2] = { &reference, &paged };
+
+  for (uint8_t i = 0; i < 2; i++) {
+    positions[position](both[i]);
+    u8g2_SetFont(both[i], testFonts[0].font);
+    u8g2_SetFontMode(both[i], 0);
+    u8g2_SetFontDirection(both[i], 0);
+    u8g2_SetDrawColor(both[i], 1);
+  }
+}
+
+// Records count random commands and draws them into the full buffer
+static void recordFrame(uint8_t count)
+{
+  uint8_t font = 0;
+
+  displayList.begin(&paged);
+  for (uint8_t i = 0; i < count; i++) {
+    uint8_t type = nextRandom(DISPLAY_GLYPH + 1);
+    if (type == DISPLAY_FONT) {
+      font = nextRandom(TEST_FONTS);
+    }
+    DisplayCommand command = randomCommand(type, font);
+    record(command);
+    target = &reference;
+    execute(command);
+  }
+  displayList.end();
+}
+
+// Replays the list for every page and compares it with the full buffer.
+// The replay starts from a different state, the list has to restore the
+// state the frame was recorded with.
+static void assertReplayMatches(uint8_t tiles)
+{
+  target = &paged;
+  for (uint8_t row = 0; row < 8; row += tiles) {
+    u8g2_SetFont(&paged, testFonts[1].font);
+    u8g2_SetDrawColor(&paged, 2);
+    u8g2_SetBufferCurrTileRow(&paged, row);
+    memset(page, 0, tiles * 128);
+    displayList.replay(&paged, execute);
+    TEST_ASSERT_EQUAL_MEMORY(u8g2_GetBufferPtr(&reference) + row * 128, page, tiles * 128);
+  }
+}
+
+void setUp(void)
+{
+  u8g2_Setup_ssd1306_i2c_128x64_noname_f(&reference, U8G2_R0, TestBus::byteCallback, TestBus::gpioCallback);
+  u8g2_Setup_ssd1306_i2c_128x64_noname_f(&paged, U8G2_R0, TestBus::byteCallback, TestBus::gpioCallback);
+  u8g2_SetupBuffer(&paged, page, PAGE_BUFFER_TILES, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+  seed = 3;
+}
+
+void tearDown(void)
+{
+}
+
+// Random frames of all command types replayed on a two page buffer draw
+// the same pages as the frames drawn into a full buffer
+void test_replay_matches_direct_draw(void)
+{
+  uint16_t replayed = 0;
+
+  for (uint16_t i = 0; i < 3000; i++) {
+    resetState(nextRandom(3));
+    u8g2_ClearBuffer(&reference);
+    recordFrame(5 + nextRandom(40));
+    if (!displayList.isComplete()) {
+      continue;
+    }
+    assertReplayMatches(PAGE_BUFFER_TILES);
+    replayed++;
+    if (i % 64 == 0) {
+      yield();
+    }
+  }
+  TEST_ASSERT_GREATER_THAN(2500, replayed);
+}
+
+// A drawing command alone is replayed on every page of a one page buffer
+// it draws on. The rows it keeps cover its pixels, and commands are culled
+// on the other pages.
+void test_rows_cover_drawn_pixels(void)
+{
+  u8g2_SetupBuffer(&paged, page, 1, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+  uint32_t culled = displayList.getCulled();
+
+  for (uint16_t i = 0; i < 5000; i++) {
+    uint8_t font = nextRandom(TEST_FONTS);
+    resetState(nextRandom(3));
+    u8g2_SetFont(&reference, testFonts[font].font);
+    u8g2_SetFont(&paged, testFonts[font].font);
+    u8g2_ClearBuffer(&reference);
+
+    DisplayCommand command = randomCommand(DISPLAY_LINE + i % (DISPLAY_GLYPH - DISPLAY_LINE + 1), font);
+    displayList.begin(&paged);
+    record(command);
+    displayList.end();
+    target = &reference;
+    execute(command);
+
+    TEST_ASSERT_TRUE(displayList.isComplete());
+    assertReplayMatches(1);
+    if (i % 256 == 0) {
+      yield();
+    }
+  }
+  TEST_ASSERT_GREATER_THAN(culled + 5000, displayList.getCulled());
+}
+
+// A frame is unchanged when its complete list is the same as the one of
+// the frame before
+void test_unchanged_frames(void)
+{
+  resetState(0);
+  recordFrame(20);
+  seed = 3;
+  resetState(0);
+  recordFrame(20);
+  TEST_ASSERT_TRUE(displayList.isComplete());
+  TEST_ASSERT_TRUE(displayList.isUnchanged());
+
+  resetState(0);
+  recordFrame(20);
+  TEST_ASSERT_FALSE(displayList.isUnchanged());
+
+  // A list of the same length with one coordinate moved
+  DisplayCommand box = randomCommand(DISPLAY_BOX, 0);
+  for (uint8_t i = 0; i < 2; i++) {
+    box.args[0] += i;
+    displayList.begin(&paged);
+    record(box);
+    displayList.end();
+  }
+  TEST_ASSERT_FALSE(displayList.isUnchanged());
+
+  // Lists that run full are never unchanged, neither is the frame after
+  for (uint8_t i = 0; i < 3; i++) {
+    seed = 3;
+    resetState(0);
+    recordFrame(i < 2 ? 255 : 20);
+    TEST_ASSERT_EQUAL(i == 2, displayList.isComplete());
+    TEST_ASSERT_FALSE(displayList.isUnchanged());
+  }
+}
+
+void runTests(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_replay_matches_direct_draw);
+  RUN_TEST(test_rows_cover_drawn_pixels);
+  RUN_TEST(test_unchanged_frames);
+  UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+  // Time for the serial monitor to connect
+  delay(2000);
+  runTests();
+}
+
+void loop()
+{
+}
+#else
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  runTests();
+  return 0;
+}
+#endif
@@ -0,0 +1,175 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <U8g2lib.h>
+#include <GlyphBlitter.h>
+#include <GlyphCache.h>
+#include <U8g2Font.h>
+#include "../support/TestBus.h"
+#include "../support/TestFonts.h"
+
+#define PAGE_BUFFER_TILES 2
+
+static u8g2_t reference;
+static u8g2_t blitted;
+static uint8_t referenceBuffer[8 * 128];
+static uint8_t blittedBuffer[8 * 128];
+static uint8_t referencePage[PAGE_BUFFER_TILES * 128];
+static uint8_t blittedPage[PAGE_BUFFER_TILES * 128];
+static uint32_t seed;
+
+// The same pseudo random background in both buffers, so that solid mode
+// and every draw color change bits that are already set
+static void fillBuffers(uint8_t *a, uint8_t *b, uint16_t size)
+{
+  for (uint16_t i = 0; i < size; i++) {
+    seed = seed * 1103515245 + 12345;
+    a[i] = b[i] = seed >> 16;
+  }
+}
+
+static void setState(const uint8_t *font, uint8_t mode, uint8_t color)
+{
+  u8g2_SetFont(&reference, font);
+  u8g2_SetFont(&blitted, font);
+  u8g2_SetFontMode(&reference, mode);
+  u8g2_SetFontMode(&blitted, mode);
+  u8g2_SetDrawColor(&reference, color);
+  u8g2_SetDrawColor(&blitted, color);
+}
+
+// Draws one glyph with u8g2_font_decode_glyph() and with the cache, which
+// decodes the glyph into a bitmap and blits it. x/y are the baseline
+// position as in u8g2_font_draw_glyph().
+static void drawBoth(uint16_t encoding, u8g2_uint_t x, u8g2_uint_t y, GlyphCache &cache)
+{
+  const uint8_t *glyphData = u8g2_font_get_glyph_data(&reference, encoding);
+  int8_t advance = 0;
+
+  TEST_ASSERT_NOT_NULL(glyphData);
+  reference.font_decode.target_x = x;
+  reference.font_decode.target_y = y;
+  blitted.font_decode.target_x = x;
+  blitted.font_decode.target_y = y;
+
+  int8_t expected = u8g2_font_decode_glyph(&reference, glyphData);
+  TEST_ASSERT_TRUE(cache.draw(&blitted, glyphData, encoding, &advance));
+  TEST_ASSERT_EQUAL_INT(expected, advance);
+}
+
+void setUp(void)
+{
+  u8g2_Setup_ssd1306_i2c_128x64_noname_f(&reference, U8G2_R0, TestBus::byteCallback, TestBus::gpioCallback);
+  u8g2_Setup_ssd1306_i2c_128x64_noname_f(&blitted, U8G2_R0, TestBus::byteCallback, TestBus::gpioCallback);
+  // The full buffer setups share one static buffer, give each its own
+  u8g2_SetupBuffer(&reference, referenceBuffer, 8, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+  u8g2_SetupBuffer(&blitted, blittedBuffer, 8, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+  seed = 1;
+}
+
+void tearDown(void)
+{
+}
+
+// Every glyph the clock draws in every font, transparent and solid, in the
+// three draw colors and at all eight row offsets within a page
+void test_full_buffer_matches_u8g2(void)
+{
+  GlyphCache cache;
+
+  for (uint8_t i = 0; i < TEST_FONTS; i++) {
+    for (uint8_t mode = 0; mode < 2; mode++) {
+      for (uint8_t color = 0; color < 3; color++) {
+        setState(testFonts[i].font, mode, color);
+        for (const char *c = testFonts[i].text; *c != '\0'; c++) {
+          for (uint8_t y = 32; y < 40; y++) {
+            fillBuffers(u8g2_GetBufferPtr(&reference), u8g2_GetBufferPtr(&blitted), 1024);
+            drawBoth((uint8_t)*c, 40 + y, y, cache);
+            TEST_ASSERT_EQUAL_MEMORY(u8g2_GetBufferPtr(&reference), u8g2_GetBufferPtr(&blitted), 1024);
+          }
+        }
+      }
+    }
+  }
+
+  TEST_ASSERT_TRUE(cache.getBlitter()->getAlignedPages() > 0);
+  TEST_ASSERT_TRUE(cache.getBlitter()->getShiftedPages() > 0);
+}
+
+// Glyphs that reach over the edges of a two page buffer are cut off there
+void test_page_buffer_matches_u8g2(void)
+{
+  GlyphCache cache;
+
+  u8g2_SetupBuffer(&reference, referencePage, PAGE_BUFFER_TILES, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+  u8g2_SetupBuffer(&blitted, blittedPage, PAGE_BUFFER_TILES, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+
+  for (uint8_t i = 0; i < TEST_FONTS; i++) {
+    for (uint8_t mode = 0; mode < 2; mode++) {
+      for (uint8_t color = 0; color < 3; color++) {
+        setState(testFonts[i].font, mode, color);
+        for (uint8_t y = 32; y < 40; y++) {
+          for (uint8_t row = 0; row < 8; row += PAGE_BUFFER_TILES) {
+            u8g2_SetBufferCurrTileRow(&reference, row);
+            u8g2_SetBufferCurrTileRow(&blitted, row);
+            fillBuffers(referencePage, blittedPage, sizeof(referencePage));
+            drawBoth((uint8_t)testFonts[i].text[0], y, y, cache);
+            TEST_ASSERT_EQUAL_MEMORY(referencePage, blittedPage, sizeof(referencePage));
+          }
+        }
+      }
+    }
+  }
+}
+
+// Cached bitmaps are blitted the same way as freshly decoded ones
+void test_cached_glyphs_match_u8g2(void)
+{
+  GlyphCache cache;
+
+  for (uint8_t i = 0; i < TEST_FONTS && i < GLYPH_CACHE_FONTS; i++) {
+    cache.addFont(testFonts[i].font);
+  }
+
+  // The second pass over a text finds its glyphs in the cache
+  for (uint8_t i = 0; i < GLYPH_CACHE_FONTS; i++) {
+    for (uint8_t pass = 0; pass < 2; pass++) {
+      setState(testFonts[i].font, pass, 1 + pass);
+      for (const char *c = testFonts[i].text; *c != '\0'; c++) {
+        fillBuffers(u8g2_GetBufferPtr(&reference), u8g2_GetBufferPtr(&blitted), 1024);
+        drawBoth((uint8_t)*c, 20, 33 + pass, cache);
+        TEST_ASSERT_EQUAL_MEMORY(u8g2_GetBufferPtr(&reference), u8g2_GetBufferPtr(&blitted), 1024);
+      }
+    }
+  }
+  TEST_ASSERT_TRUE(cache.getHits() > 0);
+}
+
+void runTests(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_full_buffer_matches_u8g2);
+  RUN_TEST(test_page_buffer_matches_u8g2);
+  RUN_TEST(test_cached_glyphs_match_u8g2);
+  UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+  // Time for the serial monitor to connect
+  delay(2000);
+  runTests();
+}
+
+void loop()
+{
+}
+#else
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  runTests();
+  return 0;
+}
+#endif
@@ -0,0 +1,129 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <U8g2lib.h>
+#include <GlyphIndex.h>
+#include <U8g2Font.h>
+#include "../support/Benchmark.h"
+#include "../support/TestBus.h"
+#include "../support/TestFonts.h"
+
+static u8g2_t reference;
+static u8g2_t indexed;
+static uint8_t referenceBuffer[8 * 128];
+static uint8_t indexedBuffer[8 * 128];
+static GlyphIndex glyphIndex;
+
+void setUp(void)
+{
+  u8g2_Setup_ssd1306_i2c_128x64_noname_f(&reference, U8G2_R0, TestBus::byteCallback, TestBus::gpioCallback);
+  u8g2_Setup_ssd1306_i2c_128x64_noname_f(&indexed, U8G2_R0, TestBus::byteCallback, TestBus::gpioCallback);
+  // The full buffer setups share one static buffer, give each its own
+  u8g2_SetupBuffer(&reference, referenceBuffer, 8, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+  u8g2_SetupBuffer(&indexed, indexedBuffer, 8, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+  u8g2_ClearBuffer(&reference);
+  u8g2_ClearBuffer(&indexed);
+  glyphIndex.clear();
+}
+
+void tearDown(void)
+{
+}
+
+void test_glyph_data_matches_u8g2(void)
+{
+  for (uint8_t i = 0; i < TEST_FONTS; i++) {
+    u8g2_SetFont(&reference, testFonts[i].font);
+    u8g2_SetFont(&indexed, testFonts[i].font);
+    for (uint16_t encoding = 0; encoding < 256; encoding++) {
+      TEST_ASSERT_TRUE(u8g2_font_get_glyph_data(&reference, encoding) == glyphIndex.getGlyphData(&indexed, encoding));
+    }
+  }
+}
+
+void test_draw_str_matches_u8g2(void)
+{
+  for (uint8_t i = 0; i < TEST_FONTS; i++) {
+    for (uint8_t mode = 0; mode < 2; mode++) {
+      u8g2_SetFont(&reference, testFonts[i].font);
+      u8g2_SetFont(&indexed, testFonts[i].font);
+      u8g2_SetFontMode(&reference, mode);
+      u8g2_SetFontMode(&indexed, mode);
+
+      u8g2_uint_t expected = u8g2_DrawStr(&reference, 3, 10 + i * 5, testFonts[i].text);
+      u8g2_uint_t actual = glyphIndex.drawStr(&indexed, 3, 10 + i * 5, testFonts[i].text);
+      TEST_ASSERT_EQUAL_UINT8(expected, actual);
+      expected = u8g2_DrawGlyph(&reference, 90, 60 - i * 5, testFonts[i].text[0]);
+      actual = glyphIndex.drawGlyph(&indexed, 90, 60 - i * 5, testFonts[i].text[0]);
+      TEST_ASSERT_EQUAL_UINT8(expected, actual);
+    }
+  }
+  TEST_ASSERT_EQUAL_MEMORY(u8g2_GetBufferPtr(&reference), u8g2_GetBufferPtr(&indexed), 1024);
+}
+
+// Cycles per glyph lookup for the text the clock draws in each font. All
+// fonts fit the index at once, as in a frame of face 5 or 6 at most four
+// fonts are used.
+void test_lookup_cycles(void)
+{
+  uint32_t walkTotal = 0;
+  uint32_t indexTotal = 0;
+
+  for (uint8_t i = 0; i < TEST_FONTS; i++) {
+    const char *text = testFonts[i].text;
+    uint16_t glyphs = strlen(text) * 10;
+
+    u8g2_SetFont(&reference, testFonts[i].font);
+    glyphIndex.getGlyphData(&reference, text[0]);
+
+    uint32_t walkCycles = benchmarkCycles([&]() {
+      for (uint8_t r = 0; r < 10; r++) {
+        for (const char *c = text; *c != '\0'; c++) {
+          benchmarkSink = (uintptr_t)u8g2_font_get_glyph_data(&reference, (uint8_t)*c);
+        }
+      }
+    }) / glyphs;
+    uint32_t indexCycles = benchmarkCycles([&]() {
+      for (uint8_t r = 0; r < 10; r++) {
+        for (const char *c = text; *c != '\0'; c++) {
+          benchmarkSink = (uintptr_t)glyphIndex.getGlyphData(&reference, (uint8_t)*c);
+        }
+      }
+    }) / glyphs;
+
+    benchmarkReport("%s: %u cycles per lookup in the glyph list, %u in the index", testFonts[i].name, (unsigned)walkCycles, (unsigned)indexCycles);
+    walkTotal += walkCycles;
+    indexTotal += indexCycles;
+  }
+
+  TEST_ASSERT_LESS_THAN(walkTotal, indexTotal);
+}
+
+void runTests(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_glyph_data_matches_u8g2);
+  RUN_TEST(test_draw_str_matches_u8g2);
+  RUN_TEST(test_lookup_cycles);
+  UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+  // Time for the serial monitor to connect
+  delay(2000);
+  runTests();
+}
+
+void loop()
+{
+}
+#else
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  runTests();
+  return 0;
+}
+#endif
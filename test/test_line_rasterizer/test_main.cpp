@@ -0,0 +1,172 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <U8g2lib.h>
+#include <LineRasterizer.h>
+#include "../support/Benchmark.h"
+#include "../support/TestBus.h"
+
+#define PAGE_BUFFER_TILES 2
+
+static u8g2_t reference;
+static u8g2_t rasterized;
+static uint8_t referenceBuffer[8 * 128];
+static uint8_t rasterizedBuffer[8 * 128];
+static uint8_t referencePage[PAGE_BUFFER_TILES * 128];
+static uint8_t rasterizedPage[PAGE_BUFFER_TILES * 128];
+static LineRasterizer rasterizer;
+static uint32_t seed;
+
+static uint16_t nextRandom(uint16_t limit)
+{
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 16) % limit;
+}
+
+// Mostly on the screen, some far off and some wrapping below zero
+static u8g2_uint_t coordinate(void)
+{
+  uint8_t kind = nextRandom(10);
+  return kind < 6 ? nextRandom(140) : kind < 8 ? nextRandom(256) : (u8g2_uint_t)(nextRandom(40) - 20);
+}
+
+static void setColor(uint8_t color)
+{
+  u8g2_SetDrawColor(&reference, color);
+  u8g2_SetDrawColor(&rasterized, color);
+}
+
+void setUp(void)
+{
+  u8g2_Setup_ssd1306_i2c_128x64_noname_f(&reference, U8G2_R0, TestBus::byteCallback, TestBus::gpioCallback);
+  u8g2_Setup_ssd1306_i2c_128x64_noname_f(&rasterized, U8G2_R0, TestBus::byteCallback, TestBus::gpioCallback);
+  // The full buffer setups share one static buffer, give each its own
+  u8g2_SetupBuffer(&reference, referenceBuffer, 8, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+  u8g2_SetupBuffer(&rasterized, rasterizedBuffer, 8, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+  u8g2_ClearBuffer(&reference);
+  u8g2_ClearBuffer(&rasterized);
+  seed = 3;
+}
+
+void tearDown(void)
+{
+}
+
+// Random lines in all three colors, some inside a clip window
+void test_full_buffer_matches_u8g2(void)
+{
+  for (uint16_t i = 0; i < 20000; i++) {
+    setColor(nextRandom(3));
+    if (nextRandom(5) == 0) {
+      u8g2_uint_t x0 = nextRandom(128);
+      u8g2_uint_t y0 = nextRandom(64);
+      u8g2_uint_t x1 = x0 + nextRandom(100);
+      u8g2_uint_t y1 = y0 + nextRandom(60);
+      u8g2_SetClipWindow(&reference, x0, y0, x1, y1);
+      u8g2_SetClipWindow(&rasterized, x0, y0, x1, y1);
+    } else {
+      u8g2_SetMaxClipWindow(&reference);
+      u8g2_SetMaxClipWindow(&rasterized);
+    }
+
+    u8g2_uint_t x1 = coordinate();
+    u8g2_uint_t y1 = coordinate() / 2;
+    u8g2_uint_t x2 = nextRandom(4) == 0 ? x1 : coordinate();
+    u8g2_uint_t y2 = nextRandom(4) == 0 ? y1 : coordinate() / 2;
+    u8g2_DrawLine(&reference, x1, y1, x2, y2);
+    rasterizer.drawLine(&rasterized, x1, y1, x2, y2);
+    TEST_ASSERT_EQUAL_MEMORY(u8g2_GetBufferPtr(&reference), u8g2_GetBufferPtr(&rasterized), 1024);
+
+    if (i % 64 == 0) {
+      u8g2_ClearBuffer(&reference);
+      u8g2_ClearBuffer(&rasterized);
+      yield();
+    }
+  }
+}
+
+// Lines cut off at the edges of every page of a two page buffer
+void test_page_buffer_matches_u8g2(void)
+{
+  u8g2_SetupBuffer(&reference, referencePage, PAGE_BUFFER_TILES, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+  u8g2_SetupBuffer(&rasterized, rasterizedPage, PAGE_BUFFER_TILES, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+
+  for (uint16_t i = 0; i < 5000; i++) {
+    setColor(nextRandom(3));
+    u8g2_uint_t x1 = coordinate();
+    u8g2_uint_t y1 = coordinate() / 2;
+    u8g2_uint_t x2 = coordinate();
+    u8g2_uint_t y2 = coordinate() / 2;
+
+    for (uint8_t row = 0; row < 8; row += PAGE_BUFFER_TILES) {
+      u8g2_SetBufferCurrTileRow(&reference, row);
+      u8g2_SetBufferCurrTileRow(&rasterized, row);
+      memset(referencePage, 0x5A, sizeof(referencePage));
+      memset(rasterizedPage, 0x5A, sizeof(rasterizedPage));
+      u8g2_DrawLine(&reference, x1, y1, x2, y2);
+      rasterizer.drawLine(&rasterized, x1, y1, x2, y2);
+      TEST_ASSERT_EQUAL_MEMORY(referencePage, rasterizedPage, sizeof(referencePage));
+    }
+    if (i % 256 == 0) {
+      yield();
+    }
+  }
+}
+
+// Lines of up to 30 pixels from the dial center, like hands and marks
+void test_lines_per_second(void)
+{
+  uint8_t lines[64][4];
+
+  for (uint8_t i = 0; i < 64; i++) {
+    lines[i][0] = 64;
+    lines[i][1] = 32;
+    lines[i][2] = 34 + nextRandom(61);
+    lines[i][3] = 2 + nextRandom(61);
+  }
+  setColor(1);
+
+  uint32_t u8g2Cycles = benchmarkCycles([&]() {
+    for (uint8_t i = 0; i < 64; i++) {
+      u8g2_DrawLine(&reference, lines[i][0], lines[i][1], lines[i][2], lines[i][3]);
+    }
+  });
+  uint32_t rasterizerCycles = benchmarkCycles([&]() {
+    for (uint8_t i = 0; i < 64; i++) {
+      rasterizer.drawLine(&rasterized, lines[i][0], lines[i][1], lines[i][2], lines[i][3]);
+    }
+  });
+
+  benchmarkReport("u8g2: %u cycles per line, %u lines/s", (unsigned)(u8g2Cycles / 64), (unsigned)benchmarkPerSecond(64, u8g2Cycles));
+  benchmarkReport("LineRasterizer: %u cycles per line, %u lines/s", (unsigned)(rasterizerCycles / 64), (unsigned)benchmarkPerSecond(64, rasterizerCycles));
+  TEST_ASSERT_LESS_THAN(u8g2Cycles, rasterizerCycles);
+}
+
+void runTests(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_full_buffer_matches_u8g2);
+  RUN_TEST(test_page_buffer_matches_u8g2);
+  RUN_TEST(test_lines_per_second);
+  UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+  // Time for the serial monitor to connect
+  delay(2000);
+  runTests();
+}
+
+void loop()
+{
+}
+#else
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  runTests();
+  return 0;
+}
+#endif
@@ -0,0 +1,221 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <U8g2lib.h>
+#include <HandTable.h>
+#include <LineRasterizer.h>
+#include <QuadFill.h>
+#include "../support/Benchmark.h"
+#include "../support/TestBus.h"
+
+#define PAGE_BUFFER_TILES 2
+
+// Every minute and hour hand of both dials main.cpp draws
+#define HANDS (2 * (60 + 360))
+
+// Frames the clock draws while the hands stand still
+#define FRAMES_PER_MINUTE 8
+
+static u8g2_t outlined;
+static u8g2_t filled;
+static uint8_t outlinedBuffer[8 * 128];
+static uint8_t filledBuffer[8 * 128];
+static uint8_t filledPage[PAGE_BUFFER_TILES * 128];
+static HandQuad hands[HANDS];
+static QuadFill quadFill;
+
+static void outline(u8g2_t *u8g2, const HandQuad &q)
+{
+  for (uint8_t i = 0; i < 4; i++) {
+    uint8_t j = (i + 1) & 3;
+    u8g2_DrawLine(u8g2, q.x[i], q.y[i], q.x[j], q.y[j]);
+  }
+}
+
+static bool pixel(u8g2_t *u8g2, uint8_t x, uint8_t y)
+{
+  return (u8g2_GetBufferPtr(u8g2)[(y >> 3) * 128 + x] >> (y & 7)) & 1;
+}
+
+void setUp(void)
+{
+  u8g2_Setup_ssd1306_i2c_128x64_noname_f(&outlined, U8G2_R0, TestBus::byteCallback, TestBus::gpioCallback);
+  u8g2_Setup_ssd1306_i2c_128x64_noname_f(&filled, U8G2_R0, TestBus::byteCallback, TestBus::gpioCallback);
+  // The full buffer setups share one static buffer, give each its own
+  u8g2_SetupBuffer(&outlined, outlinedBuffer, 8, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+  u8g2_SetupBuffer(&filled, filledBuffer, 8, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+
+  uint16_t n = 0;
+  for (uint8_t m = 0; m < 60; m++) {
+    hands[n++] = HandGeometry<64, 39, 23>::minute(m);
+    hands[n++] = HandGeometry<104, 39, 23>::minute(m);
+  }
+  for (uint16_t angle = 0; angle < 360; angle++) {
+    hands[n++] = HandGeometry<64, 39, 23>::hour(angle);
+    hands[n++] = HandGeometry<104, 39, 23>::hour(angle);
+  }
+}
+
+void tearDown(void)
+{
+}
+
+// Every row of a filled hand runs from the leftmost to the rightmost pixel
+// of the outline u8g2_DrawLine() draws in that row
+void test_fill_covers_outline_rows(void)
+{
+  for (uint16_t i = 0; i < HANDS; i++) {
+    u8g2_ClearBuffer(&outlined);
+    u8g2_ClearBuffer(&filled);
+    outline(&outlined, hands[i]);
+    quadFill.fill(&filled, hands[i].x, hands[i].y);
+
+    for (uint8_t y = 0; y < 64; y++) {
+      int16_t left = 128;
+      int16_t right = -1;
+      for (uint8_t x = 0; x < 128; x++) {
+        if (pixel(&outlined, x, y)) {
+          left = x < left ? x : left;
+          right = x;
+        }
+      }
+      for (uint8_t x = 0; x < 128; x++) {
+        TEST_ASSERT_EQUAL(x >= left && x <= right, pixel(&filled, x, y));
+      }
+    }
+    if (i % 64 == 0) {
+      yield();
+    }
+  }
+}
+
+// The pages of a two page buffer match the full buffer in all three colors
+void test_page_buffer_matches_full_buffer(void)
+{
+  u8g2_SetupBuffer(&outlined, filledPage, PAGE_BUFFER_TILES, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+
+  for (uint16_t i = 0; i < HANDS; i++) {
+    for (uint8_t color = 0; color < 3; color++) {
+      u8g2_SetDrawColor(&filled, color);
+      u8g2_SetDrawColor(&outlined, color);
+      memset(u8g2_GetBufferPtr(&filled), 0x5A, 1024);
+      quadFill.fill(&filled, hands[i].x, hands[i].y);
+
+      for (uint8_t row = 0; row < 8; row += PAGE_BUFFER_TILES) {
+        u8g2_SetBufferCurrTileRow(&outlined, row);
+        memset(filledPage, 0x5A, sizeof(filledPage));
+        quadFill.fill(&outlined, hands[i].x, hands[i].y);
+        TEST_ASSERT_EQUAL_MEMORY(u8g2_GetBufferPtr(&filled) + row * 128, filledPage, sizeof(filledPage));
+      }
+    }
+    if (i % 64 == 0) {
+      yield();
+    }
+  }
+}
+
+// Rows taken from the cache match the rows of a newly stepped quad, also
+// after the other entries were replaced
+void test_cached_rows_match(void)
+{
+  for (uint16_t i = 0; i < HANDS; i++) {
+    const HandQuad &q = hands[i];
+    const HandQuad &other = hands[(i * 7 + 1) % HANDS];
+    QuadFill fresh;
+
+    u8g2_ClearBuffer(&outlined);
+    u8g2_ClearBuffer(&filled);
+    fresh.fill(&outlined, q.x, q.y);
+
+    quadFill.fill(&filled, q.x, q.y);
+    quadFill.fill(&filled, other.x, other.y);
+    u8g2_ClearBuffer(&filled);
+    uint32_t hits = quadFill.getHits();
+    quadFill.fill(&filled, q.x, q.y);
+    TEST_ASSERT_EQUAL(hits + 1, quadFill.getHits());
+    TEST_ASSERT_EQUAL_MEMORY(u8g2_GetBufferPtr(&outlined), u8g2_GetBufferPtr(&filled), 1024);
+  }
+}
+
+static void drawOutline(LineRasterizer &lineRasterizer, const HandQuad &q)
+{
+  for (uint8_t k = 0; k < 4; k++) {
+    uint8_t j = (k + 1) & 3;
+    lineRasterizer.drawLine(&outlined, q.x[k], q.y[k], q.x[j], q.y[j]);
+  }
+}
+
+// The hands of a clock over one hour, a minute and an hour hand per frame
+// and FRAMES_PER_MINUTE frames per minute. Filled hands take less time
+// than outline hands drawn with four lines. The cost of a quad whose rows
+// are not cached yet is reported as well, it is about that of the outline.
+void test_hands_per_second(void)
+{
+  LineRasterizer lineRasterizer;
+  const uint16_t frameHands = 60 * FRAMES_PER_MINUTE * 2;
+
+  uint32_t outlineCycles = benchmarkCycles([&]() {
+    for (uint8_t m = 0; m < 60; m++) {
+      for (uint8_t frame = 0; frame < FRAMES_PER_MINUTE; frame++) {
+        drawOutline(lineRasterizer, hands[2 * m]);
+        drawOutline(lineRasterizer, hands[120 + 2 * (300 + m / 2)]);
+      }
+    }
+  });
+  uint32_t fillCycles = benchmarkCycles([&]() {
+    for (uint8_t m = 0; m < 60; m++) {
+      for (uint8_t frame = 0; frame < FRAMES_PER_MINUTE; frame++) {
+        const HandQuad &minute = hands[2 * m];
+        const HandQuad &hour = hands[120 + 2 * (300 + m / 2)];
+        quadFill.fill(&filled, minute.x, minute.y);
+        quadFill.fill(&filled, hour.x, hour.y);
+      }
+    }
+  });
+  uint32_t coldOutlineCycles = benchmarkCycles([&]() {
+    for (uint16_t i = 0; i < HANDS; i++) {
+      drawOutline(lineRasterizer, hands[i]);
+    }
+  });
+  uint32_t coldFillCycles = benchmarkCycles([&]() {
+    for (uint16_t i = 0; i < HANDS; i++) {
+      quadFill.fill(&filled, hands[i].x, hands[i].y);
+    }
+  });
+
+  benchmarkReport("Outline: %u cycles per hand, %u hands/s", (unsigned)(outlineCycles / frameHands), (unsigned)benchmarkPerSecond(frameHands, outlineCycles));
+  benchmarkReport("Filled: %u cycles per hand, %u hands/s", (unsigned)(fillCycles / frameHands), (unsigned)benchmarkPerSecond(frameHands, fillCycles));
+  benchmarkReport("Every hand once, outline: %u cycles per hand", (unsigned)(coldOutlineCycles / HANDS));
+  benchmarkReport("Every hand once, filled: %u cycles per hand", (unsigned)(coldFillCycles / HANDS));
+  TEST_ASSERT_LESS_THAN(outlineCycles, fillCycles);
+}
+
+void runTests(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_fill_covers_outline_rows);
+  RUN_TEST(test_page_buffer_matches_full_buffer);
+  RUN_TEST(test_cached_rows_match);
+  RUN_TEST(test_hands_per_second);
+  UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+  // Time for the serial monitor to connect
+  delay(2000);
+  runTests();
+}
+
+void loop()
+{
+}
+#else
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  runTests();
+  return 0;
+}
+#endif
@@ -0,0 +1,150 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <RenderScheduler.h>
+
+static RenderScheduler *scheduler;
+static RenderInputs inputs;
+
+void setUp(void)
+{
+  scheduler = new RenderScheduler();
+  memset(&inputs, 0, sizeof(inputs));
+  inputs.second = 5;
+  inputs.minute = 10;
+  inputs.hour = 12;
+}
+
+void tearDown(void)
+{
+  delete scheduler;
+}
+
+// The first frame and the first frame after invalidate() are drawn
+void test_first_frame_is_rendered(void)
+{
+  TEST_ASSERT_TRUE(scheduler->shouldRender(inputs, RENDER_DEPENDS_ALL));
+  TEST_ASSERT_FALSE(scheduler->shouldRender(inputs, RENDER_DEPENDS_ALL));
+  scheduler->invalidate();
+  TEST_ASSERT_TRUE(scheduler->shouldRender(inputs, RENDER_DEPENDS_ALL));
+  TEST_ASSERT_EQUAL(2, scheduler->getFramesRendered());
+  TEST_ASSERT_EQUAL(1, scheduler->getFramesSkipped());
+}
+
+// Only inputs the screen depends on cause a frame
+void test_only_dependencies_are_rendered(void)
+{
+  uint8_t dependencies = RENDER_DEPENDS_MINUTE | RENDER_DEPENDS_TRANSFER;
+
+  TEST_ASSERT_TRUE(scheduler->shouldRender(inputs, dependencies));
+  inputs.second++;
+  inputs.wifiConnected = true;
+  inputs.rtcPresent = true;
+  TEST_ASSERT_FALSE(scheduler->shouldRender(inputs, dependencies));
+  inputs.minute++;
+  TEST_ASSERT_TRUE(scheduler->shouldRender(inputs, dependencies));
+  inputs.transferData = true;
+  TEST_ASSERT_TRUE(scheduler->shouldRender(inputs, dependencies));
+  TEST_ASSERT_FALSE(scheduler->shouldRender(inputs, dependencies));
+}
+
+// Every input is compared with the last drawn frame
+void test_every_input_is_compared(void)
+{
+  TEST_ASSERT_TRUE(scheduler->shouldRender(inputs, RENDER_DEPENDS_ALL));
+
+  inputs.hour++;
+  TEST_ASSERT_TRUE(scheduler->shouldRender(inputs, RENDER_DEPENDS_HOUR));
+  inputs.dayOfWeek++;
+  TEST_ASSERT_TRUE(scheduler->shouldRender(inputs, RENDER_DEPENDS_DATE));
+  inputs.year++;
+  TEST_ASSERT_TRUE(scheduler->shouldRender(inputs, RENDER_DEPENDS_DATE));
+  inputs.wifiConnected = true;
+  TEST_ASSERT_TRUE(scheduler->shouldRender(inputs, RENDER_DEPENDS_WIFI));
+  inputs.otaState = 3;
+  TEST_ASSERT_TRUE(scheduler->shouldRender(inputs, RENDER_DEPENDS_OTA));
+  inputs.rtcPresent = true;
+  TEST_ASSERT_TRUE(scheduler->shouldRender(inputs, RENDER_DEPENDS_RTC));
+  TEST_ASSERT_FALSE(scheduler->shouldRender(inputs, RENDER_DEPENDS_ALL));
+}
+
+// A screen change is drawn even when the screen depends on nothing
+void test_screen_change_is_rendered(void)
+{
+  TEST_ASSERT_TRUE(scheduler->shouldRender(inputs, 0));
+  TEST_ASSERT_FALSE(scheduler->shouldRender(inputs, 0));
+  inputs.screen = 2;
+  TEST_ASSERT_TRUE(scheduler->shouldRender(inputs, 0));
+}
+
+// Clock changes within the period are held back and drawn after it
+void test_clock_changes_wait_for_period(void)
+{
+  TEST_ASSERT_TRUE(scheduler->shouldRender(inputs, RENDER_DEPENDS_ALL, 100));
+  inputs.second++;
+  TEST_ASSERT_FALSE(scheduler->shouldRender(inputs, RENDER_DEPENDS_ALL, 100));
+  inputs.day++;
+  TEST_ASSERT_FALSE(scheduler->shouldRender(inputs, RENDER_DEPENDS_ALL, 100));
+  delay(150);
+  TEST_ASSERT_TRUE(scheduler->shouldRender(inputs, RENDER_DEPENDS_ALL, 100));
+  TEST_ASSERT_FALSE(scheduler->shouldRender(inputs, RENDER_DEPENDS_ALL, 100));
+}
+
+// Like an HTTP request right after a frame, other inputs are drawn at once
+// together with the clock changes held back so far
+void test_events_bypass_period(void)
+{
+  TEST_ASSERT_TRUE(scheduler->shouldRender(inputs, RENDER_DEPENDS_ALL, 500));
+  inputs.second++;
+  TEST_ASSERT_FALSE(scheduler->shouldRender(inputs, RENDER_DEPENDS_ALL, 500));
+
+  inputs.transferData = true;
+  TEST_ASSERT_TRUE(scheduler->shouldRender(inputs, RENDER_DEPENDS_ALL, 500));
+  inputs.transferData = false;
+  TEST_ASSERT_TRUE(scheduler->shouldRender(inputs, RENDER_DEPENDS_ALL, 500));
+  inputs.wifiConnected = true;
+  TEST_ASSERT_TRUE(scheduler->shouldRender(inputs, RENDER_DEPENDS_ALL, 500));
+  inputs.otaState = 1;
+  TEST_ASSERT_TRUE(scheduler->shouldRender(inputs, RENDER_DEPENDS_ALL, 500));
+  inputs.rtcPresent = true;
+  TEST_ASSERT_TRUE(scheduler->shouldRender(inputs, RENDER_DEPENDS_ALL, 500));
+
+  // The held back second was drawn with the first event
+  TEST_ASSERT_FALSE(scheduler->shouldRender(inputs, RENDER_DEPENDS_ALL, 500));
+
+  // Unless the screen does not depend on it
+  inputs.transferData = true;
+  TEST_ASSERT_FALSE(scheduler->shouldRender(inputs, RENDER_DEPENDS_CLOCK, 500));
+}
+
+void runTests(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_first_frame_is_rendered);
+  RUN_TEST(test_only_dependencies_are_rendered);
+  RUN_TEST(test_every_input_is_compared);
+  RUN_TEST(test_screen_change_is_rendered);
+  RUN_TEST(test_clock_changes_wait_for_period);
+  RUN_TEST(test_events_bypass_period);
+  UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+  // Time for the serial monitor to connect
+  delay(2000);
+  runTests();
+}
+
+void loop()
+{
+}
+#else
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  runTests();
+  return 0;
+}
+#endif
@@ -0,0 +1,207 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <U8g2lib.h>
+#include <RingRenderer.h>
+#include "../support/TestBus.h"
+
+#define PAGE_BUFFER_TILES 2
+
+static u8g2_t reference;
+static u8g2_t rendered;
+static uint8_t referenceBuffer[8 * 128];
+static uint8_t renderedBuffer[8 * 128];
+static uint8_t referencePage[PAGE_BUFFER_TILES * 128];
+static uint8_t renderedPage[PAGE_BUFFER_TILES * 128];
+static RingRenderer *ringRenderer;
+static uint32_t seed;
+
+// Centers on the screen, next to its edges and off it, some close enough
+// to the end of the coordinates that the ring wraps around
+static const u8g2_uint_t centersX[] = { 0, 1, 5, 30, 64, 100, 122, 127, 128, 140, 200, 230, 250 };
+static const u8g2_uint_t centersY[] = { 0, 3, 7, 8, 15, 16, 31, 32, 47, 60, 63, 64, 80, 230, 250 };
+
+static uint16_t nextRandom(uint16_t limit)
+{
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 16) % limit;
+}
+
+// The same pseudo random background in both buffers, so that clearing
+// pixels shows
+static void fillBuffers(uint8_t *a, uint8_t *b, uint16_t size)
+{
+  for (uint16_t i = 0; i < size; i++) {
+    a[i] = b[i] = nextRandom(256);
+  }
+}
+
+static void setColor(uint8_t color)
+{
+  u8g2_SetDrawColor(&reference, color);
+  u8g2_SetDrawColor(&rendered, color);
+}
+
+static void drawCircles(u8g2_t *u8g2, u8g2_uint_t x0, u8g2_uint_t y0, u8g2_uint_t inner, u8g2_uint_t outer)
+{
+  for (u8g2_uint_t r = inner; r <= outer && r >= inner; r++) {
+    u8g2_DrawCircle(u8g2, x0, y0, r, U8G2_DRAW_ALL);
+  }
+}
+
+static void assertRing(u8g2_uint_t x0, u8g2_uint_t y0, u8g2_uint_t inner, u8g2_uint_t outer)
+{
+  fillBuffers(referenceBuffer, renderedBuffer, sizeof(referenceBuffer));
+  drawCircles(&reference, x0, y0, inner, outer);
+  ringRenderer->drawRing(&rendered, x0, y0, inner, outer);
+  TEST_ASSERT_EQUAL_MEMORY(referenceBuffer, renderedBuffer, sizeof(referenceBuffer));
+}
+
+void setUp(void)
+{
+  u8g2_Setup_ssd1306_i2c_128x64_noname_f(&reference, U8G2_R0, TestBus::byteCallback, TestBus::gpioCallback);
+  u8g2_Setup_ssd1306_i2c_128x64_noname_f(&rendered, U8G2_R0, TestBus::byteCallback, TestBus::gpioCallback);
+  // The full buffer setups share one static buffer, give each its own
+  u8g2_SetupBuffer(&reference, referenceBuffer, 8, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+  u8g2_SetupBuffer(&rendered, renderedBuffer, 8, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+  ringRenderer = new RingRenderer();
+  seed = 3;
+}
+
+void tearDown(void)
+{
+  delete ringRenderer;
+}
+
+// Every pair of radii in set and clear color, at the dial center of face 3
+void test_rings_match_u8g2(void)
+{
+  for (uint8_t color = 0; color < 2; color++) {
+    setColor(color);
+    for (u8g2_uint_t outer = 0; outer <= RING_RENDERER_MAX_RADIUS; outer++) {
+      for (u8g2_uint_t inner = 0; inner <= outer; inner++) {
+        assertRing(64, 32, inner, outer);
+      }
+      yield();
+    }
+  }
+}
+
+// Rings cut off at the edges of the screen and wrapping around the end of
+// the coordinates
+void test_clipped_rings_match_u8g2(void)
+{
+  setColor(1);
+  for (uint8_t i = 0; i < sizeof(centersX); i++) {
+    for (uint8_t j = 0; j < sizeof(centersY); j++) {
+      for (uint8_t k = 0; k < 8; k++) {
+        u8g2_uint_t outer = nextRandom(RING_RENDERER_MAX_RADIUS + 1);
+        assertRing(centersX[i], centersY[j], outer - nextRandom(outer + 1), outer);
+      }
+    }
+    yield();
+  }
+}
+
+// Rings cut off at the edges of every page of a two page buffer
+void test_page_buffer_matches_u8g2(void)
+{
+  u8g2_SetupBuffer(&reference, referencePage, PAGE_BUFFER_TILES, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+  u8g2_SetupBuffer(&rendered, renderedPage, PAGE_BUFFER_TILES, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+
+  for (uint16_t i = 0; i < 2000; i++) {
+    setColor(nextRandom(2));
+    u8g2_uint_t x0 = centersX[nextRandom(sizeof(centersX))];
+    u8g2_uint_t y0 = centersY[nextRandom(sizeof(centersY))];
+    u8g2_uint_t outer = nextRandom(RING_RENDERER_MAX_RADIUS + 1);
+    u8g2_uint_t inner = outer - nextRandom(outer + 1);
+
+    for (uint8_t row = 0; row < 8; row += PAGE_BUFFER_TILES) {
+      u8g2_SetBufferCurrTileRow(&reference, row);
+      u8g2_SetBufferCurrTileRow(&rendered, row);
+      fillBuffers(referencePage, renderedPage, sizeof(referencePage));
+      drawCircles(&reference, x0, y0, inner, outer);
+      ringRenderer->drawRing(&rendered, x0, y0, inner, outer);
+      TEST_ASSERT_EQUAL_MEMORY(referencePage, renderedPage, sizeof(referencePage));
+    }
+    if (i % 256 == 0) {
+      yield();
+    }
+  }
+}
+
+// Rings with more runs per row than a slot holds, larger than the slots
+// and in XOR color are drawn by u8g2
+void test_fallback_matches_u8g2(void)
+{
+  uint8_t tooManyRuns = 0;
+
+  setColor(1);
+  for (u8g2_uint_t outer = 0; outer <= RING_RENDERER_MAX_RADIUS; outer++) {
+    for (u8g2_uint_t inner = 0; inner <= outer; inner++) {
+      uint32_t spans = ringRenderer->getSpans();
+      assertRing(64, 32, inner, outer);
+      if (ringRenderer->getSpans() == spans) {
+        tooManyRuns++;
+      }
+    }
+  }
+  TEST_ASSERT_GREATER_THAN(0, tooManyRuns);
+
+  assertRing(64, 32, 20, RING_RENDERER_MAX_RADIUS + 1);
+  assertRing(64, 32, RING_RENDERER_MAX_RADIUS + 1, RING_RENDERER_MAX_RADIUS + 10);
+
+  setColor(2);
+  for (u8g2_uint_t outer = 0; outer <= RING_RENDERER_MAX_RADIUS; outer += 3) {
+    assertRing(64, 32, outer / 2, outer);
+    assertRing(5, 60, outer / 2, outer);
+  }
+}
+
+// The band covers the pixels of the circles of the ring
+void test_annulus_covers_ring(void)
+{
+  setColor(1);
+  for (u8g2_uint_t outer = 0; outer <= RING_RENDERER_MAX_RADIUS; outer++) {
+    for (u8g2_uint_t inner = 0; inner <= outer; inner++) {
+      u8g2_ClearBuffer(&reference);
+      u8g2_ClearBuffer(&rendered);
+      drawCircles(&reference, 64, 32, inner, outer);
+      ringRenderer->drawAnnulus(&rendered, 64, 32, inner, outer);
+      for (uint16_t i = 0; i < sizeof(referenceBuffer); i++) {
+        TEST_ASSERT_EQUAL_HEX8(referenceBuffer[i], referenceBuffer[i] & renderedBuffer[i]);
+      }
+    }
+  }
+}
+
+void runTests(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_rings_match_u8g2);
+  RUN_TEST(test_clipped_rings_match_u8g2);
+  RUN_TEST(test_page_buffer_matches_u8g2);
+  RUN_TEST(test_fallback_matches_u8g2);
+  RUN_TEST(test_annulus_covers_ring);
+  UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+  // Time for the serial monitor to connect
+  delay(2000);
+  runTests();
+}
+
+void loop()
+{
+}
+#else
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  runTests();
+  return 0;
+}
+#endif
@@ -0,0 +1,206 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <U8g2lib.h>
+#include <RulerStrip.h>
+#include "../support/TestBus.h"
+
+#define PAGE_BUFFER_TILES 2
+
+static u8g2_t reference;
+static u8g2_t stripped;
+static uint8_t referenceBuffer[8 * 128];
+static uint8_t strippedBuffer[8 * 128];
+static uint8_t strippedPage[PAGE_BUFFER_TILES * 128];
+static RulerStrip strip;
+
+// Baselines of the tapes on the faces, and some that cut the strip off at
+// the top of the screen
+static const uint8_t baselines[] = { 8, 12, 30, 31, 46, 47, 60, 63 };
+
+// The fonts main.cpp draws the tapes with
+static const uint8_t *const fonts[] = { u8g2_font_haxrcorp4089_tn, u8g2_font_glasstown_nbp_tn };
+
+// The tapes as main.cpp drew them before the strips, with the label offset
+// wrapped to 8 bits like the float passed to drawText()
+static void drawLabel(u8g2_t *u8g2, uint8_t value, uint8_t x, uint8_t y)
+{
+  char s[3];
+  snprintf(s, sizeof(s), "%d", value);
+  u8g2_DrawStr(u8g2, x, y, s);
+}
+
+static void drawSeconds(u8g2_t *u8g2, uint8_t s, uint8_t y)
+{
+  uint8_t first = s < 30 ? s + 30 : s - 30;
+
+  for (uint8_t i = 0; i < 70; i++) {
+    uint8_t step = (first + i) % 60;
+    if (step % 15 == 0) {
+      u8g2_DrawLine(u8g2, i * 2, y - 2, i * 2, y);
+      drawLabel(u8g2, step, i * 2 - (step == 0 ? 2 : step == 15 ? 4 : 5), y - 4);
+    }
+  }
+}
+
+static void drawMinutes(u8g2_t *u8g2, uint8_t m, uint8_t y)
+{
+  uint8_t first = m < 30 ? m + 30 : m - 30;
+
+  for (uint8_t i = 0; i < 70; i++) {
+    uint8_t step = (first + i) % 60;
+    if (step % 5 == 0) {
+      u8g2_DrawLine(u8g2, i * 2, y - 2, i * 2, y);
+    }
+    if (step % 15 == 0) {
+      drawLabel(u8g2, step, i * 2 - (step == 0 ? 2 : step == 15 ? 4 : 5), y - 4);
+    }
+  }
+}
+
+static void drawHours(u8g2_t *u8g2, uint8_t h, uint8_t y)
+{
+  uint8_t first = h < 12 ? h + 12 : h - 12;
+
+  for (uint8_t i = 0; i < 28; i++) {
+    uint8_t step = (first + i) % 24;
+    u8g2_DrawLine(u8g2, i * 5, y - 2, i * 5, y);
+    if (step % 3 == 0) {
+      drawLabel(u8g2, step, i * 5 - (step <= 10 ? 2 : 4), y - 4);
+    }
+  }
+}
+
+struct Tape {
+  void (*draw)(u8g2_t *u8g2, uint8_t value, uint8_t y);
+  uint8_t halfTurn;
+  uint8_t pixelsPerStep;
+  uint8_t stepsPerLabel;
+};
+
+static const Tape tapes[] = {
+  { drawSeconds, 30, 2, 15 },
+  { drawMinutes, 30, 2, 15 },
+  { drawHours, 12, 5, 3 }
+};
+
+static void setFont(const uint8_t *font)
+{
+  u8g2_SetFont(&reference, font);
+  u8g2_SetFont(&stripped, font);
+}
+
+// Captures the strip like prepareRuler() in main.cpp
+static void capture(const Tape &tape, const uint8_t *font)
+{
+  u8g2_ClearBuffer(&stripped);
+  tape.draw(&stripped, tape.halfTurn, RULER_STRIP_HEIGHT - 1);
+  strip.capture(&stripped, font, tape.halfTurn * 2 * tape.pixelsPerStep, tape.stepsPerLabel * tape.pixelsPerStep);
+}
+
+// Offset of the strip for a value like drawRuler() in main.cpp
+static uint8_t offset(const Tape &tape, uint8_t value)
+{
+  return (value < tape.halfTurn ? value + tape.halfTurn : value - tape.halfTurn) * tape.pixelsPerStep;
+}
+
+void setUp(void)
+{
+  u8g2_Setup_ssd1306_i2c_128x64_noname_f(&reference, U8G2_R0, TestBus::byteCallback, TestBus::gpioCallback);
+  u8g2_Setup_ssd1306_i2c_128x64_noname_f(&stripped, U8G2_R0, TestBus::byteCallback, TestBus::gpioCallback);
+  // The full buffer setups share one static buffer, give each its own
+  u8g2_SetupBuffer(&reference, referenceBuffer, 8, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+  u8g2_SetupBuffer(&stripped, strippedBuffer, 8, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+  u8g2_SetFontMode(&reference, 1);
+  u8g2_SetFontMode(&stripped, 1);
+  strip.invalidate();
+}
+
+void tearDown(void)
+{
+}
+
+// Every value of every tape in both fonts at every baseline matches the
+// tape drawn directly
+void test_full_buffer_matches_drawn_tape(void)
+{
+  for (uint8_t f = 0; f < 2; f++) {
+    setFont(fonts[f]);
+    for (uint8_t t = 0; t < 3; t++) {
+      const Tape &tape = tapes[t];
+      capture(tape, fonts[f]);
+      TEST_ASSERT_TRUE(strip.isRendered(fonts[f]));
+
+      for (uint8_t value = 0; value < tape.halfTurn * 2; value++) {
+        for (uint8_t b = 0; b < sizeof(baselines); b++) {
+          u8g2_ClearBuffer(&reference);
+          u8g2_ClearBuffer(&stripped);
+          tape.draw(&reference, value, baselines[b]);
+          strip.draw(&stripped, offset(tape, value), baselines[b]);
+          TEST_ASSERT_EQUAL_MEMORY(u8g2_GetBufferPtr(&reference), u8g2_GetBufferPtr(&stripped), 1024);
+        }
+      }
+      yield();
+    }
+  }
+}
+
+// The strip ORed into the pages of a two page buffer, with the strip cut
+// off at the page edges
+void test_page_buffer_matches_full_buffer(void)
+{
+  for (uint8_t f = 0; f < 2; f++) {
+    setFont(fonts[f]);
+    for (uint8_t t = 0; t < 3; t++) {
+      const Tape &tape = tapes[t];
+      capture(tape, fonts[f]);
+      u8g2_SetupBuffer(&stripped, strippedPage, PAGE_BUFFER_TILES, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+
+      for (uint8_t value = 0; value < tape.halfTurn * 2; value++) {
+        for (uint8_t b = 0; b < sizeof(baselines); b++) {
+          u8g2_ClearBuffer(&reference);
+          tape.draw(&reference, value, baselines[b]);
+          for (uint8_t row = 0; row < 8; row += PAGE_BUFFER_TILES) {
+            u8g2_SetBufferCurrTileRow(&stripped, row);
+            memset(strippedPage, 0, sizeof(strippedPage));
+            strip.draw(&stripped, offset(tape, value), baselines[b]);
+            TEST_ASSERT_EQUAL_MEMORY(u8g2_GetBufferPtr(&reference) + row * 128, strippedPage, sizeof(strippedPage));
+          }
+        }
+      }
+
+      u8g2_SetupBuffer(&stripped, strippedBuffer, 8, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+      u8g2_SetFontMode(&stripped, 1);
+      u8g2_SetFont(&stripped, fonts[f]);
+      yield();
+    }
+  }
+}
+
+void runTests(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_full_buffer_matches_drawn_tape);
+  RUN_TEST(test_page_buffer_matches_full_buffer);
+  UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+  // Time for the serial monitor to connect
+  delay(2000);
+  runTests();
+}
+
+void loop()
+{
+}
+#else
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  runTests();
+  return 0;
+}
+#endif
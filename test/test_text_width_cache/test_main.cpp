@@ -0,0 +1,132 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <U8g2lib.h>
+#include <TextWidthCache.h>
+#include "../support/TestBus.h"
+#include "../support/TestFonts.h"
+
+static u8g2_t u8g2;
+static TextWidthCache *cache;
+static uint32_t seed;
+
+static uint16_t nextRandom(uint16_t limit)
+{
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 16) % limit;
+}
+
+// Characters of the clock's text plus ones the numeric fonts do not have
+static void randomString(char *s, uint8_t size)
+{
+  static const char characters[] = "0123456789: -/.,ADJNSabcdeyz\x7F";
+  uint8_t length = 1 + nextRandom(size - 1);
+
+  for (uint8_t i = 0; i < length; i++) {
+    s[i] = characters[nextRandom(sizeof(characters) - 1)];
+  }
+  s[length] = '\0';
+}
+
+static void assertWidth(const char *s)
+{
+  u8g2_uint_t expected = u8g2_GetStrWidth(&u8g2, s);
+  TEST_ASSERT_EQUAL_MESSAGE(expected, cache->getStrWidth(&u8g2, s), s);
+}
+
+void setUp(void)
+{
+  u8g2_Setup_ssd1306_i2c_128x64_noname_f(&u8g2, U8G2_R0, TestBus::byteCallback, TestBus::gpioCallback);
+  cache = new TextWidthCache();
+  seed = 3;
+}
+
+void tearDown(void)
+{
+  delete cache;
+}
+
+// The text of every font, measured again from the cache
+void test_cached_widths_match_u8g2(void)
+{
+  for (uint8_t i = 0; i < TEST_FONTS; i++) {
+    u8g2_SetFont(&u8g2, testFonts[i].font);
+    assertWidth(testFonts[i].text);
+  }
+  for (uint8_t i = 0; i < TEST_FONTS; i++) {
+    u8g2_SetFont(&u8g2, testFonts[i].font);
+    assertWidth(testFonts[i].text);
+  }
+  TEST_ASSERT_EQUAL(TEST_FONTS, cache->getHits());
+  TEST_ASSERT_EQUAL(TEST_FONTS, cache->getMisses());
+}
+
+// More strings than entries, so most are measured again after they were
+// replaced
+void test_evicted_widths_match_u8g2(void)
+{
+  char s[12];
+
+  for (uint16_t i = 0; i < 4000; i++) {
+    u8g2_SetFont(&u8g2, testFonts[nextRandom(TEST_FONTS)].font);
+    randomString(s, sizeof(s));
+    assertWidth(s);
+  }
+  TEST_ASSERT_GREATER_THAN(TEXT_WIDTH_CACHE_SIZE, cache->getMisses());
+}
+
+// Monospaced fonts like main.cpp registers them, with strings whose
+// glyphs are not all in the font
+void test_monospace_widths_match_u8g2(void)
+{
+  char s[12];
+
+  for (uint8_t i = 0; i < TEST_FONTS; i++) {
+    if (testFonts[i].font == u8g2_font_7x14B_tf || testFonts[i].font == u8g2_font_profont12_tn) {
+      cache->addMonospaceFont(testFonts[i].font);
+    }
+  }
+
+  for (uint8_t font = 0; font < 2; font++) {
+    u8g2_SetFont(&u8g2, font == 0 ? u8g2_font_7x14B_tf : u8g2_font_profont12_tn);
+    assertWidth("Jan 05 2019, SAT");
+    assertWidth("0123456789");
+    assertWidth("12 ");
+    assertWidth("1A");
+    assertWidth("A");
+    for (uint16_t i = 0; i < 2000; i++) {
+      randomString(s, sizeof(s));
+      assertWidth(s);
+    }
+  }
+  TEST_ASSERT_GREATER_THAN(0, cache->getMonospaceHits());
+}
+
+void runTests(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_cached_widths_match_u8g2);
+  RUN_TEST(test_evicted_widths_match_u8g2);
+  RUN_TEST(test_monospace_widths_match_u8g2);
+  UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+  // Time for the serial monitor to connect
+  delay(2000);
+  runTests();
+}
+
+void loop()
+{
+}
+#else
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  runTests();
+  return 0;
+}
+#endif
@@ -0,0 +1,509 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <U8g2lib.h>
+#include <TileTransport.h>
+#include "../support/TestBus.h"
+
+// Time every bus transaction takes while the bus is slowed down
+#define SLOW_BUS_MICROS 200
+
+static u8g2_t u8g2;
+static uint8_t buffer[8 * 128];
+static TileTransport *transport;
+static uint32_t seed;
+static bool slowBus;
+
+// The controller's display RAM, one byte per page and column like the
+// frame buffer, and the registers that decide where data bytes go
+static uint8_t ram[8 * 128];
+static uint8_t column;
+static uint8_t page;
+static uint8_t columnStart;
+static uint8_t columnEnd;
+static uint8_t pageStart;
+static uint8_t pageEnd;
+static uint8_t addressingMode;
+static uint8_t command;
+static uint8_t arguments[2];
+static uint8_t argumentCount;
+
+static uint16_t nextRandom(uint16_t limit)
+{
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 16) % limit;
+}
+
+static uint8_t byteCallback(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void *arg_ptr)
+{
+  if (slowBus && msg == U8X8_MSG_BYTE_START_TRANSFER) {
+    delayMicroseconds(SLOW_BUS_MICROS);
+  }
+  return TestBus::byteCallback(u8x8, msg, arg_int, arg_ptr);
+}
+
+static uint8_t argumentsOf(uint8_t c)
+{
+  switch (c) {
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+      return 1;
+    case 0x21: case 0x22:
+      return 2;
+  }
+  return 0;
+}
+
+static void executeCommand(void)
+{
+  if (command == 0x20) {
+    addressingMode = arguments[0];
+  } else if (command == 0x21) {
+    columnStart = column = arguments[0];
+    columnEnd = arguments[1];
+  } else if (command == 0x22) {
+    pageStart = page = arguments[0];
+    pageEnd = arguments[1];
+  } else if (command >= 0xB0 && command <= 0xB7) {
+    page = command & 0x07;
+  } else if (command <= 0x0F) {
+    column = (column & 0xF0) | command;
+  } else if (command <= 0x1F) {
+    column = (column & 0x0F) | (command & 0x0F) << 4;
+  }
+}
+
+// Data bytes advance the column, in horizontal mode within the window
+// and on to the next page of the window
+static void writeData(uint8_t b)
+{
+  ram[page * 128 + column] = b;
+  if (addressingMode != 0x00) {
+    if (column < 127) {
+      column++;
+    }
+  } else if (column++ == columnEnd) {
+    column = columnStart;
+    page = page == pageEnd ? pageStart : page + 1;
+  }
+}
+
+// Feeds what the bus logged since the last reset to the controller
+static void applyLog(void)
+{
+  const uint16_t *log = TestBus::log();
+
+  TEST_ASSERT_TRUE(TestBus::logLength() < TEST_BUS_LOG_SIZE);
+  for (uint16_t i = 0; i < TestBus::logLength(); i++) {
+    if (log[i] & TEST_BUS_DATA_BIT) {
+      writeData(log[i] & 0xFF);
+    } else if (argumentCount < argumentsOf(command)) {
+      arguments[argumentCount++] = log[i];
+      if (argumentCount == argumentsOf(command)) {
+        executeCommand();
+      }
+    } else {
+      command = log[i];
+      argumentCount = 0;
+      if (argumentsOf(command) == 0) {
+        executeCommand();
+      }
+    }
+  }
+  TestBus::reset();
+}
+
+static uint16_t sendFrame(void)
+{
+  uint16_t sent = transport->send();
+  applyLog();
+  return sent;
+}
+
+static void assertDisplayShowsBuffer(void)
+{
+  TEST_ASSERT_EQUAL_MEMORY(buffer, ram, sizeof(ram));
+}
+
+// Flips one random pixel of a tile
+static void changeTile(uint8_t tx, uint8_t ty)
+{
+  buffer[(ty * 16 + tx) * 8 + nextRandom(8)] ^= 1 << nextRandom(8);
+}
+
+// A frame where tile rows 0 to 7 each have one changed tile, and row 2
+// also a run of ten
+static void changeScatteredTiles(void)
+{
+  for (uint8_t ty = 0; ty < 8; ty++) {
+    changeTile(15 - ty, ty);
+  }
+  for (uint8_t tx = 0; tx < 10; tx++) {
+    changeTile(tx, 2);
+  }
+}
+
+static void changeBlock(uint8_t tx0, uint8_t ty0, uint8_t tx1, uint8_t ty1)
+{
+  for (uint8_t ty = ty0; ty <= ty1; ty++) {
+    for (uint8_t tx = tx0; tx <= tx1; tx++) {
+      changeTile(tx, ty);
+    }
+  }
+}
+
+// Counts command bytes 0x21 and 0x22 in the log
+static uint8_t countWindowCommands(void)
+{
+  uint8_t count = 0;
+
+  for (uint16_t i = 0; i < TestBus::logLength(); i++) {
+    if (TestBus::log()[i] == 0x21 || TestBus::log()[i] == 0x22) {
+      count++;
+    }
+  }
+  return count;
+}
+
+void setUp(void)
+{
+  seed = 3;
+  slowBus = false;
+  u8g2_Setup_ssd1306_i2c_128x64_noname_f(&u8g2, U8G2_R0, byteCallback, TestBus::gpioCallback);
+  u8g2_SetupBuffer(&u8g2, buffer, 8, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+
+  // Display RAM holds noise after power on
+  for (uint16_t i = 0; i < sizeof(ram); i++) {
+    ram[i] = nextRandom(256);
+  }
+  column = 0;
+  page = 0;
+  columnStart = 0;
+  columnEnd = 127;
+  pageStart = 0;
+  pageEnd = 7;
+  addressingMode = 0x02;
+  command = 0xE3;
+  argumentCount = 0;
+
+  TestBus::reset();
+  u8g2_InitDisplay(&u8g2);
+  u8g2_SetPowerSave(&u8g2, 0);
+  applyLog();
+
+  transport = new TileTransport();
+  transport->begin(&u8g2);
+  u8g2_ClearBuffer(&u8g2);
+}
+
+void tearDown(void)
+{
+  delete transport;
+}
+
+// The first frame and the first after invalidate() are sent whole, an
+// unchanged frame not at all
+void test_first_frame_is_sent_whole(void)
+{
+  u8g2_DrawBox(&u8g2, 3, 5, 50, 40);
+  TEST_ASSERT_EQUAL_UINT16(1024, sendFrame());
+  assertDisplayShowsBuffer();
+
+  TEST_ASSERT_EQUAL_UINT16(0, sendFrame());
+  TEST_ASSERT_EQUAL_UINT8(0, transport->getLastRuns());
+  TEST_ASSERT_EQUAL_UINT16(1024, transport->getLastBytesSaved());
+
+  transport->invalidate();
+  TestBus::reset();
+  TEST_ASSERT_EQUAL_UINT16(1024, transport->send());
+  TEST_ASSERT_EQUAL_UINT32(1024, TestBus::dataBytes());
+  applyLog();
+  assertDisplayShowsBuffer();
+}
+
+// Any changed pixel makes its tile dirty and only that tile is sent
+void test_changed_tile_is_sent_alone(void)
+{
+  sendFrame();
+
+  for (uint8_t ty = 0; ty < 8; ty++) {
+    for (uint8_t tx = 0; tx < 16; tx++) {
+      changeTile(tx, ty);
+      TestBus::reset();
+      TEST_ASSERT_EQUAL_UINT16(8, transport->send());
+      TEST_ASSERT_EQUAL_UINT32(8, TestBus::dataBytes());
+      TEST_ASSERT_EQUAL_UINT8(1, transport->getLastRuns());
+      applyLog();
+      assertDisplayShowsBuffer();
+    }
+  }
+}
+
+// A single clean tile between two dirty ones is sent with them, two are not
+void test_runs_merge_single_gaps(void)
+{
+  sendFrame();
+
+  changeTile(2, 5);
+  changeTile(4, 5);
+  TEST_ASSERT_EQUAL_UINT16(24, sendFrame());
+  TEST_ASSERT_EQUAL_UINT8(1, transport->getLastRuns());
+  assertDisplayShowsBuffer();
+
+  changeTile(2, 5);
+  changeTile(5, 5);
+  TEST_ASSERT_EQUAL_UINT16(16, sendFrame());
+  TEST_ASSERT_EQUAL_UINT8(2, transport->getLastRuns());
+  assertDisplayShowsBuffer();
+
+  changeTile(0, 1);
+  changeTile(2, 1);
+  changeTile(4, 1);
+  changeTile(15, 1);
+  TEST_ASSERT_EQUAL_UINT16(48, sendFrame());
+  TEST_ASSERT_EQUAL_UINT8(2, transport->getLastRuns());
+  assertDisplayShowsBuffer();
+}
+
+// Random frames of boxes, lines and pixels end up on the display
+void test_random_frames_reach_display(void)
+{
+  uint16_t windowedFrames = 0;
+
+  sendFrame();
+  for (uint16_t frame = 0; frame < 500; frame++) {
+    u8g2_SetDrawColor(&u8g2, nextRandom(3));
+    switch (nextRandom(4)) {
+      case 0:
+        u8g2_DrawBox(&u8g2, nextRandom(128), nextRandom(64), 1 + nextRandom(40), 1 + nextRandom(30));
+        break;
+      case 1:
+        u8g2_DrawLine(&u8g2, nextRandom(128), nextRandom(64), nextRandom(128), nextRandom(64));
+        break;
+      case 2:
+        u8g2_DrawPixel(&u8g2, nextRandom(128), nextRandom(64));
+        break;
+    }
+
+    TestBus::reset();
+    uint16_t sent = transport->send();
+    TEST_ASSERT_EQUAL_UINT32(sent, TestBus::dataBytes());
+    TEST_ASSERT_EQUAL_UINT16(1024, sent + transport->getLastBytesSaved());
+    if (transport->getLastWindowed()) {
+      windowedFrames++;
+    }
+    applyLog();
+    assertDisplayShowsBuffer();
+  }
+  TEST_ASSERT_GREATER_THAN(0, windowedFrames);
+  TEST_ASSERT_LESS_THAN(500, windowedFrames);
+}
+
+// A page buffer is sent page by page by u8g2
+void test_page_buffer_is_sent_whole(void)
+{
+  static uint8_t page[2 * 128];
+
+  u8g2_SetupBuffer(&u8g2, page, 2, u8g2_ll_hvline_vertical_top_lsb, &u8g2_cb_r0);
+  transport->begin(&u8g2);
+  TestBus::reset();
+  TEST_ASSERT_EQUAL_UINT16(256, transport->send());
+  TEST_ASSERT_EQUAL_UINT32(256, TestBus::dataBytes());
+}
+
+// Each slice picks up where the last one stopped and sends at most its
+// tiles, no tile goes twice
+void test_poll_resumes_across_slices(void)
+{
+  sendFrame();
+  changeScatteredTiles();
+
+  uint8_t polls = 0;
+  TEST_ASSERT_TRUE(transport->start());
+  TEST_ASSERT_FALSE(transport->getLastWindowed());
+  do {
+    TestBus::reset();
+    polls++;
+    transport->poll(4, 60000);
+    TEST_ASSERT_TRUE(TestBus::dataBytes() <= 4 * 8);
+    applyLog();
+  } while (transport->isBusy());
+
+  assertDisplayShowsBuffer();
+  TEST_ASSERT_EQUAL_UINT16(18 * 8, transport->getLastBytesSent());
+  TEST_ASSERT_EQUAL_UINT8(polls, transport->getLastPolls());
+  TEST_ASSERT_TRUE(polls >= 18 / 4 + 1);
+  TEST_ASSERT_FALSE(transport->poll(4, 60000));
+  TEST_ASSERT_EQUAL_UINT8(polls, transport->getLastPolls());
+}
+
+// A used up time budget ends the slice after the run in progress, the
+// slice after the last run finds the frame complete
+void test_poll_stops_at_time_budget(void)
+{
+  sendFrame();
+  changeScatteredTiles();
+
+  transport->start();
+  while (transport->poll(0xFF, 0)) {
+  }
+  applyLog();
+
+  assertDisplayShowsBuffer();
+  TEST_ASSERT_EQUAL_UINT8(transport->getLastRuns() + 1, transport->getLastPolls());
+}
+
+// The longest slice of the frame, started again with every frame
+void test_worst_poll_is_longest_slice(void)
+{
+  uint32_t longest = 0;
+
+  sendFrame();
+  changeScatteredTiles();
+
+  slowBus = true;
+  transport->start();
+  do {
+    uint32_t startTime = micros();
+    transport->poll(4, 60000);
+    uint32_t elapsed = micros() - startTime;
+    if (elapsed > longest) {
+      longest = elapsed;
+    }
+  } while (transport->isBusy());
+  applyLog();
+
+  TEST_ASSERT_TRUE(transport->getLastWorstPoll() >= SLOW_BUS_MICROS);
+  TEST_ASSERT_TRUE(transport->getLastWorstPoll() <= longest);
+
+  slowBus = false;
+  transport->start();
+  TEST_ASSERT_EQUAL_UINT32(0, transport->getLastWorstPoll());
+  TEST_ASSERT_EQUAL_UINT8(0, transport->getLastPolls());
+}
+
+// A full frame is one window and one data phase, without page commands
+void test_full_frame_is_one_window(void)
+{
+  u8g2_DrawBox(&u8g2, 3, 5, 50, 40);
+  sendFrame();
+  u8g2_DrawBox(&u8g2, 60, 20, 50, 40);
+
+  transport->invalidate();
+  TestBus::reset();
+  transport->send();
+  TEST_ASSERT_TRUE(transport->getLastWindowed());
+  TEST_ASSERT_EQUAL_UINT8(1, transport->getLastRuns());
+  TEST_ASSERT_EQUAL_UINT32(1024, TestBus::dataBytes());
+  TEST_ASSERT_EQUAL_UINT16(1024 + 8, TestBus::logLength());
+  TEST_ASSERT_EQUAL_UINT8(2, countWindowCommands());
+  applyLog();
+  assertDisplayShowsBuffer();
+}
+
+// The dirty rectangle goes as a window when that costs less than its runs
+void test_window_only_when_cheaper(void)
+{
+  sendFrame();
+
+  // Three runs of three tiles cost 3 * (24 + 8), the window 72 + 18
+  changeBlock(5, 2, 7, 4);
+  TEST_ASSERT_EQUAL_UINT16(72, sendFrame());
+  TEST_ASSERT_TRUE(transport->getLastWindowed());
+  assertDisplayShowsBuffer();
+
+  // Two runs of two tiles cost 2 * (16 + 8), the window 32 + 18
+  changeBlock(5, 2, 6, 3);
+  TEST_ASSERT_EQUAL_UINT16(32, sendFrame());
+  TEST_ASSERT_FALSE(transport->getLastWindowed());
+  TEST_ASSERT_EQUAL_UINT8(2, transport->getLastRuns());
+  assertDisplayShowsBuffer();
+
+  // Opposite corners, the window would be the whole frame
+  changeTile(0, 0);
+  changeTile(15, 7);
+  TEST_ASSERT_EQUAL_UINT16(16, sendFrame());
+  TEST_ASSERT_FALSE(transport->getLastWindowed());
+  assertDisplayShowsBuffer();
+}
+
+// After a partial window the runs of the next frame land where they belong
+void test_full_window_restored_after_partial_window(void)
+{
+  sendFrame();
+
+  changeBlock(5, 2, 7, 4);
+  TestBus::reset();
+  transport->send();
+  TEST_ASSERT_TRUE(transport->getLastWindowed());
+  TEST_ASSERT_EQUAL_UINT8(4, countWindowCommands());
+  applyLog();
+  TEST_ASSERT_EQUAL_UINT8(0, columnStart);
+  TEST_ASSERT_EQUAL_UINT8(127, columnEnd);
+  TEST_ASSERT_EQUAL_UINT8(0, pageStart);
+  TEST_ASSERT_EQUAL_UINT8(7, pageEnd);
+
+  // Right of and below the window
+  changeTile(14, 6);
+  changeTile(13, 0);
+  changeTile(15, 0);
+  TEST_ASSERT_EQUAL_UINT16(32, sendFrame());
+  TEST_ASSERT_FALSE(transport->getLastWindowed());
+  assertDisplayShowsBuffer();
+}
+
+// A window row is never split, a slice sends at least one
+void test_window_rows_are_sliced(void)
+{
+  sendFrame();
+  changeBlock(5, 2, 7, 4);
+
+  TEST_ASSERT_TRUE(transport->start());
+  TEST_ASSERT_TRUE(transport->getLastWindowed());
+  for (uint8_t row = 0; row < 3; row++) {
+    TestBus::reset();
+    transport->poll(1, 60000);
+    TEST_ASSERT_EQUAL_UINT32(24, TestBus::dataBytes());
+    applyLog();
+  }
+  TEST_ASSERT_FALSE(transport->poll(1, 60000));
+  TEST_ASSERT_EQUAL_UINT8(4, transport->getLastPolls());
+  assertDisplayShowsBuffer();
+}
+
+void runTests(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_first_frame_is_sent_whole);
+  RUN_TEST(test_changed_tile_is_sent_alone);
+  RUN_TEST(test_runs_merge_single_gaps);
+  RUN_TEST(test_random_frames_reach_display);
+  RUN_TEST(test_page_buffer_is_sent_whole);
+  RUN_TEST(test_poll_resumes_across_slices);
+  RUN_TEST(test_poll_stops_at_time_budget);
+  RUN_TEST(test_worst_poll_is_longest_slice);
+  RUN_TEST(test_full_frame_is_one_window);
+  RUN_TEST(test_window_only_when_cheaper);
+  RUN_TEST(test_full_window_restored_after_partial_window);
+  RUN_TEST(test_window_rows_are_sliced);
+  UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+  // Time for the serial monitor to connect
+  delay(2000);
+  runTests();
+}
+
+void loop()
+{
+}
+#else
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  runTests();
+  return 0;
+}
+#endif
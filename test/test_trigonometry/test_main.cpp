@@ -0,0 +1,259 @@
+#include <Arduino.h>
+#include <unity.h>
+#include <Trigonometry.h>
+#include <HandTable.h>
+#include "../support/Benchmark.h"
+
+// Dial geometries of faces 2 and 3, see prepareModeTwo() and prepareModeThree()
+typedef HandTable<64, 39, 23> CenterDialHands;
+typedef HandTable<104, 39, 23> RightDialHands;
+
+#define DIAL_RADIUS 23
+
+// The vertices a frame of an analog face computes: twelve hour marks, the
+// second marker and the two hands
+#define FRAME_VERTICES 34
+
+struct FrameVertices {
+  uint8_t x[FRAME_VERTICES];
+  uint8_t y[FRAME_VERTICES];
+};
+
+// The float math the faces used before, with the 0.0175 degree constant and
+// the coordinates truncated on the way into u8g2
+static void floatVertex(uint8_t centerX, uint8_t centerY, int16_t radius, int16_t angle, uint8_t *x, uint8_t *y)
+{
+  float fx = radius * cos(angle * 0.0175);
+  float fy = radius * sin(angle * 0.0175);
+
+  *x = (uint8_t)(fx + centerX);
+  *y = (uint8_t)(fy + centerY);
+}
+
+static void floatHand(uint8_t centerX, uint8_t centerY, int16_t angle, int16_t tip, int16_t tail, int16_t side, int16_t spread, uint8_t *x, uint8_t *y)
+{
+  floatVertex(centerX, centerY, DIAL_RADIUS - tip, angle, &x[0], &y[0]);
+  floatVertex(centerX, centerY, DIAL_RADIUS - side, angle + spread, &x[1], &y[1]);
+  floatVertex(centerX, centerY, DIAL_RADIUS - tail, angle, &x[2], &y[2]);
+  floatVertex(centerX, centerY, DIAL_RADIUS - side, angle - spread, &x[3], &y[3]);
+}
+
+static void floatFrame(uint8_t centerX, uint8_t centerY, uint8_t h, uint8_t m, uint8_t s, FrameVertices &v)
+{
+  uint8_t i = 0;
+
+  for (uint8_t mark = 0; mark < 12; mark++, i += 2) {
+    floatVertex(centerX, centerY, DIAL_RADIUS - 1, mark * 30 + 270, &v.x[i], &v.y[i]);
+    floatVertex(centerX, centerY, DIAL_RADIUS - 5, mark * 30 + 270, &v.x[i + 1], &v.y[i + 1]);
+  }
+  floatVertex(centerX, centerY, DIAL_RADIUS - 1, s * 6 + 270, &v.x[i], &v.y[i]);
+  floatVertex(centerX, centerY, DIAL_RADIUS - 5, s * 6 + 270, &v.x[i + 1], &v.y[i + 1]);
+  i += 2;
+  floatHand(centerX, centerY, m * 6 + 270, MINUTE_HAND_TIP, MINUTE_HAND_TAIL, MINUTE_HAND_SIDE, MINUTE_HAND_SPREAD, &v.x[i], &v.y[i]);
+  i += 4;
+  floatHand(centerX, centerY, h * 30 + m / 2 + 270, HOUR_HAND_TIP, HOUR_HAND_TAIL, HOUR_HAND_SIDE, HOUR_HAND_SPREAD, &v.x[i], &v.y[i]);
+}
+
+static void storeQuad(const HandQuad &q, uint8_t *x, uint8_t *y)
+{
+  memcpy(x, q.x, 4);
+  memcpy(y, q.y, 4);
+}
+
+// The same frame with the sine table and the hand tables
+template <class Table>
+static void tableFrame(uint8_t centerX, uint8_t centerY, uint8_t h, uint8_t m, uint8_t s, FrameVertices &v)
+{
+  uint8_t i = 0;
+
+  for (uint8_t mark = 0; mark < 12; mark++, i += 2) {
+    Trigonometry::Point p1 = Trigonometry::polar(centerX, centerY, DIAL_RADIUS - 1, mark * 30 + 270);
+    Trigonometry::Point p2 = Trigonometry::polar(centerX, centerY, DIAL_RADIUS - 5, mark * 30 + 270);
+    v.x[i] = p1.x;
+    v.y[i] = p1.y;
+    v.x[i + 1] = p2.x;
+    v.y[i + 1] = p2.y;
+  }
+  Trigonometry::Point p1 = Trigonometry::polar(centerX, centerY, DIAL_RADIUS - 1, s * 6 + 270);
+  Trigonometry::Point p2 = Trigonometry::polar(centerX, centerY, DIAL_RADIUS - 5, s * 6 + 270);
+  v.x[i] = p1.x;
+  v.y[i] = p1.y;
+  v.x[i + 1] = p2.x;
+  v.y[i + 1] = p2.y;
+  i += 2;
+  storeQuad(Table::minute(m), &v.x[i], &v.y[i]);
+  i += 4;
+  storeQuad(Table::hour(h, m), &v.x[i], &v.y[i]);
+}
+
+// The hand without a table, as drawHand() computes it for other geometries
+static HandQuad polarHand(uint8_t centerX, uint8_t centerY, int16_t angle, int16_t tip, int16_t tail, int16_t side, int16_t spread)
+{
+  Trigonometry::Point p1 = Trigonometry::polar(centerX, centerY, DIAL_RADIUS - tip, angle);
+  Trigonometry::Point p2 = Trigonometry::polar(centerX, centerY, DIAL_RADIUS - tail, angle);
+  Trigonometry::Point p3 = Trigonometry::polar(centerX, centerY, DIAL_RADIUS - side, angle + spread);
+  Trigonometry::Point p4 = Trigonometry::polar(centerX, centerY, DIAL_RADIUS - side, angle - spread);
+  HandQuad q = {
+    { (uint8_t)p1.x, (uint8_t)p3.x, (uint8_t)p2.x, (uint8_t)p4.x },
+    { (uint8_t)p1.y, (uint8_t)p3.y, (uint8_t)p2.y, (uint8_t)p4.y }
+  };
+  return q;
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_sine_table_is_rounded_sine(void)
+{
+  for (int16_t degree = 0; degree < 360; degree++) {
+    double expected = ::sin(degree * PI / 180.0) * TRIGONOMETRY_Q15_ONE;
+    TEST_ASSERT_TRUE(fabs(Trigonometry::sin(degree) - expected) <= 0.5 + 1e-6);
+    TEST_ASSERT_EQUAL_INT16(Trigonometry::q15Sine(degree), Trigonometry::sin(degree));
+  }
+  TEST_ASSERT_EQUAL_INT16(Trigonometry::sin(30), Trigonometry::sin(-330));
+  TEST_ASSERT_EQUAL_INT16(Trigonometry::cos(0), Trigonometry::sin(450));
+}
+
+void test_polar_matches_compile_time_polar(void)
+{
+  for (int16_t radius = -4; radius <= 22; radius++) {
+    for (int16_t degree = -360; degree < 720; degree++) {
+      TEST_ASSERT_EQUAL_INT16(Trigonometry::polarXAt(radius, degree), Trigonometry::polarX(radius, degree));
+      TEST_ASSERT_EQUAL_INT16(Trigonometry::polarYAt(radius, degree), Trigonometry::polarY(radius, degree));
+    }
+  }
+}
+
+template <class Table>
+static void checkHandTable(uint8_t centerX, uint8_t centerY)
+{
+  TEST_ASSERT_TRUE(Table::matches(centerX, centerY, DIAL_RADIUS));
+
+  for (uint8_t m = 0; m < 60; m++) {
+    HandQuad expected = polarHand(centerX, centerY, m * 6 + 270, MINUTE_HAND_TIP, MINUTE_HAND_TAIL, MINUTE_HAND_SIDE, MINUTE_HAND_SPREAD);
+    HandQuad actual = Table::minute(m);
+    TEST_ASSERT_EQUAL_MEMORY(&expected, &actual, sizeof(HandQuad));
+  }
+  for (uint8_t h = 0; h < 12; h++) {
+    for (uint8_t m = 0; m < 60; m++) {
+      HandQuad expected = polarHand(centerX, centerY, h * 30 + m / 2 + 270, HOUR_HAND_TIP, HOUR_HAND_TAIL, HOUR_HAND_SIDE, HOUR_HAND_SPREAD);
+      HandQuad actual = Table::hour(h, m);
+      TEST_ASSERT_EQUAL_MEMORY(&expected, &actual, sizeof(HandQuad));
+    }
+  }
+}
+
+void test_hand_tables_match_runtime_hands(void)
+{
+  checkHandTable<CenterDialHands>(64, 39);
+  checkHandTable<RightDialHands>(104, 39);
+}
+
+// Exact pi/180 with rounding instead of 0.0175 with truncation moves some
+// vertices by one pixel, never more
+template <class Table>
+static void compareWithFloat(const char *face, uint8_t centerX, uint8_t centerY)
+{
+  uint16_t moved[3] = { 0, 0, 0 };
+  uint16_t total[3] = { 0, 0, 0 };
+  FrameVertices before;
+  FrameVertices after;
+
+  // Every second, minute and hour+minute position once
+  for (uint16_t t = 0; t < 720; t++) {
+    uint8_t h = t / 60;
+    uint8_t m = t % 60;
+    floatFrame(centerX, centerY, h, m, m, before);
+    tableFrame<Table>(centerX, centerY, h, m, m, after);
+
+    for (uint8_t i = 0; i < FRAME_VERTICES; i++) {
+      // Marks, second marker and hands
+      uint8_t kind = i < 24 ? 0 : i < 26 ? 1 : 2;
+      if (t >= 60 && i < 30) {
+        continue;
+      }
+      int16_t dx = (int16_t)after.x[i] - before.x[i];
+      int16_t dy = (int16_t)after.y[i] - before.y[i];
+      TEST_ASSERT_TRUE(dx >= -1 && dx <= 1 && dy >= -1 && dy <= 1);
+      total[kind]++;
+      if (dx != 0 || dy != 0) {
+        moved[kind]++;
+      }
+    }
+  }
+
+  benchmarkReport("%s: %u/%u mark, %u/%u second, %u/%u hand vertices moved by 1 px", face,
+    (unsigned)(moved[0] / 60), (unsigned)(total[0] / 60), (unsigned)moved[1], (unsigned)total[1], (unsigned)moved[2], (unsigned)total[2]);
+}
+
+void test_vertices_move_at_most_one_pixel(void)
+{
+  compareWithFloat<CenterDialHands>("face 2", 64, 39);
+  compareWithFloat<RightDialHands>("face 3", 104, 39);
+}
+
+template <class Table>
+static void benchmarkFace(const char *face, uint8_t centerX, uint8_t centerY)
+{
+  FrameVertices v;
+
+  // One frame for each minute of an hour
+  uint32_t floatCycles = benchmarkCycles([&]() {
+    for (uint8_t m = 0; m < 60; m++) {
+      floatFrame(centerX, centerY, m % 12, m, m, v);
+      benchmarkSink = v.x[m % FRAME_VERTICES];
+    }
+  }) / 60;
+  uint32_t tableCycles = benchmarkCycles([&]() {
+    for (uint8_t m = 0; m < 60; m++) {
+      tableFrame<Table>(centerX, centerY, m % 12, m, m, v);
+      benchmarkSink = v.x[m % FRAME_VERTICES];
+    }
+  }) / 60;
+
+  benchmarkReport("%s: %u cycles per frame with float, %u with the tables", face, (unsigned)floatCycles, (unsigned)tableCycles);
+  TEST_ASSERT_LESS_THAN(floatCycles, tableCycles);
+}
+
+void test_cycles_per_frame(void)
+{
+  benchmarkFace<CenterDialHands>("face 2", 64, 39);
+  benchmarkFace<RightDialHands>("face 3", 104, 39);
+}
+
+void runTests(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_sine_table_is_rounded_sine);
+  RUN_TEST(test_polar_matches_compile_time_polar);
+  RUN_TEST(test_hand_tables_match_runtime_hands);
+  RUN_TEST(test_vertices_move_at_most_one_pixel);
+  RUN_TEST(test_cycles_per_frame);
+  UNITY_END();
+}
+
+#ifdef ARDUINO
+void setup()
+{
+  // Time for the serial monitor to connect
+  delay(2000);
+  runTests();
+}
+
+void loop()
+{
+}
+#else
+int main(int argc, char **argv)
+{
+  (void)argc;
+  (void)argv;
+  runTests();
+  return 0;
+}
+#endif